@@ -42,11 +42,20 @@
 #include <algorithm>
 #include <limits>
 #include <cfloat>
+#include <cstdlib>
+#include <cstring>
 #include "EclipseGridParser.hpp"
 #include "EclipseGridParserHelpers.hpp"
 #include "SpecialEclipseFields.hpp"
 #include <dune/common/ErrorMacros.hpp>
+#include <dune/common/StopWatch.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/cstdint.hpp>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -55,86 +64,79 @@ using namespace std;
 namespace Dune
 {
 
-// ---------- List of supported keywords ----------
+namespace {
 
-namespace EclipseKeywords
-{
-    string integer_fields[] =
-	{ string("ACTNUM"),
-	  string("SATNUM"),
-	  string("EQLNUM"),
-	  string("REGNUM"),
-	  string("ROCKTYPE"),
-	  string("DIMENS"),
-	  string("REGDIMS"),
-	  string("WELLDIMS"),
-	  string("TABDIMS"),
-          string("FIPNUM"),
-          string("GRIDFILE")
-	};
-    const int num_integer_fields = sizeof(integer_fields) / sizeof(integer_fields[0]);
-
-    string floating_fields[] =
-        { string("COORD"),    string("ZCORN"),      string("PERMX"),
-          string("PERMY"),    string("PERMZ"),      string("PERMXX"),
-          string("PERMYY"),   string("PERMZZ"),     string("PERMXY"),
-          string("PERMYZ"),   string("PERMZX"),     string("PORO"),
-          string("BULKMOD"),  string("YOUNGMOD"),   string("LAMEMOD"),
-          string("SHEARMOD"), string("POISSONMOD"), string("PWAVEMOD"),
-          string("MULTPV")
-        };
-    const int num_floating_fields = sizeof(floating_fields) / sizeof(floating_fields[0]);
-
-    string special_fields[] =
-        { string("SPECGRID"), string("FAULTS"), string("MULTFLT"),
-          string("TITLE"),    string("START"),  string("DATES"),
-	  string("DENSITY"),  string("PVDG"),   string("PVDO"),
-	  string("PVTG"),     string("PVTO"),   string("PVTW"),
-	  string("SGOF"),     string("SWOF"),   string("ROCKTAB"),
-	  string("ROCK"),
-	  // The following fields only have a dummy implementation
-	  // that allows us to ignore them.
-          "SWFN",
-          "SOF2",
-          "EQUIL",
-          "WELSPECS",
-          "COMPDAT",
-          "WCONINJE",
-          "TUNING"
-        };
-
-    const int num_special_fields = sizeof(special_fields) / sizeof(special_fields[0]);
-
-    string ignore_with_data[] =
-	{ string("MAPUNITS"), string("MAPAXES"),  string("GRIDUNIT"),
-	  string("NTG"),      string("REGDIMS"),  string("WELLDIMS"),
-	  string("NSTACK"),   string("SATNUM"),
-	  string("RPTRST"),   string("ROIP"),     string("RWIP"),
-	  string("RWSAT"),    string("RPR"),      string("WBHP"),
-	  string("WOIR"),     string("TSTEP"),    string("BOX"),
-          string("COORDSYS")
-	};
-    const int num_ignore_with_data = sizeof(ignore_with_data) / sizeof(ignore_with_data[0]);
-
-    string ignore_no_data[] =
-	{ string("RUNSPEC"), string("WATER"),    string("OIL"),
-	  string("METRIC"),  string("FMTIN"),    string("FMTOUT"),
-	  string("GRID"),    string("INIT"),     string("NOECHO"),
-	  string("ECHO"),    string("EDIT"),     string("PROPS"),
-	  string("REGIONS"), string("SOLUTION"), string("SUMMARY"),
-	  string("FPR"),     string("FOIP"),     string("FWIP"),
-	  string("RUNSUM"),  string("EXCEL"),    string("SCHEDULE"),
-	  string("END"),     string("ENDBOX"),   string("CONTINUE")
-	};
-    const int num_ignore_no_data = sizeof(ignore_no_data) / sizeof(ignore_no_data[0]);
-
-    string include_keywords[] = { string("INCLUDE") };
-    const int num_include_keywords = sizeof(include_keywords) / sizeof(include_keywords[0]);
-
-
-} // namespace EclipseKeywords
+    // Size of the buffer used when reading eclipse files. Much
+    // larger than the default, since the bulk data fields of
+    // typical decks are hundreds of megabytes.
+    const int file_buffer_size = 1 << 20;
 
-namespace {
+    // A read-only stream buffer over data in memory.
+    class MemoryBuffer : public std::streambuf
+    {
+    public:
+	MemoryBuffer(const char* begin, const char* end)
+	{
+	    setg(const_cast<char*>(begin), const_cast<char*>(begin), const_cast<char*>(end));
+	}
+    };
+
+    // A read-only stream buffer over a memory-mapped file. The whole
+    // file is the get area, so reading never copies data or calls
+    // underflow() before the end of the file.
+    class MappedFileBuffer : public std::streambuf
+    {
+    public:
+	explicit MappedFileBuffer(const string& filename)
+	    : data_(0), size_(0)
+	{
+	    int fd = open(filename.c_str(), O_RDONLY);
+	    if (fd < 0) {
+		return;
+	    }
+	    struct stat st;
+	    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		void* addr = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED) {
+		    data_ = static_cast<char*>(addr);
+		    size_ = st.st_size;
+		    madvise(addr, size_, MADV_SEQUENTIAL);
+		    setg(data_, data_, data_ + size_);
+		}
+	    }
+	    close(fd);
+	}
+	~MappedFileBuffer()
+	{
+	    if (data_) {
+		munmap(data_, size_);
+	    }
+	}
+	bool isOpen() const
+	{
+	    return data_ != 0;
+	}
+	const char* data() const
+	{
+	    return data_;
+	}
+	size_t size() const
+	{
+	    return size_;
+	}
+	// The current read position.
+	const char* position() const
+	{
+	    return gptr();
+	}
+    private:
+	MappedFileBuffer(const MappedFileBuffer&);
+	MappedFileBuffer& operator=(const MappedFileBuffer&);
+	char* data_;
+	size_t size_;
+    };
+
+    // ---------- List of supported keywords ----------
 
     enum FieldType {
 	Integer,
@@ -143,26 +145,353 @@ namespace {
 	IgnoreWithData,
 	IgnoreNoData,
         Include,
-	Unknown
+	Unknown,
+	Deferred
+    };
+
+    struct KeywordInfo
+    {
+	const char* name;
+	FieldType type;
+	bool cell_field; // Integer or floating point field with one value per cell.
+    };
+
+    // All supported keywords. Must be sorted by name (in strcmp()
+    // order), since it is searched by findKeyword().
+    // The special fields SWFN, SOF2, EQUIL, WELSPECS, COMPDAT,
+    // WCONINJE and TUNING only have a dummy implementation that
+    // allows us to ignore them.
+    const KeywordInfo keyword_table[] =
+    {
+	{ "ACTNUM",     Integer,         true  },
+	{ "BOX",        IgnoreWithData,  false },
+	{ "BULKMOD",    FloatingPoint,   true  },
+	{ "COMPDAT",    SpecialField,    false },
+	{ "CONTINUE",   IgnoreNoData,    false },
+	{ "COORD",      FloatingPoint,   false },
+	{ "COORDSYS",   IgnoreWithData,  false },
+	{ "DATES",      SpecialField,    false },
+	{ "DENSITY",    SpecialField,    false },
+	{ "DIMENS",     Integer,         false },
+	{ "ECHO",       IgnoreNoData,    false },
+	{ "EDIT",       IgnoreNoData,    false },
+	{ "END",        IgnoreNoData,    false },
+	{ "ENDBOX",     IgnoreNoData,    false },
+	{ "EQLNUM",     Integer,         true  },
+	{ "EQUIL",      SpecialField,    false },
+	{ "EXCEL",      IgnoreNoData,    false },
+	{ "FAULTS",     SpecialField,    false },
+	{ "FIPNUM",     Integer,         true  },
+	{ "FMTIN",      IgnoreNoData,    false },
+	{ "FMTOUT",     IgnoreNoData,    false },
+	{ "FOIP",       IgnoreNoData,    false },
+	{ "FPR",        IgnoreNoData,    false },
+	{ "FWIP",       IgnoreNoData,    false },
+	{ "GRID",       IgnoreNoData,    false },
+	{ "GRIDFILE",   Integer,         false },
+	{ "GRIDUNIT",   IgnoreWithData,  false },
+	{ "INCLUDE",    Include,         false },
+	{ "INIT",       IgnoreNoData,    false },
+	{ "LAMEMOD",    FloatingPoint,   true  },
+	{ "MAPAXES",    IgnoreWithData,  false },
+	{ "MAPUNITS",   IgnoreWithData,  false },
+	{ "METRIC",     IgnoreNoData,    false },
+	{ "MULTFLT",    SpecialField,    false },
+	{ "MULTPV",     FloatingPoint,   true  },
+	{ "NOECHO",     IgnoreNoData,    false },
+	{ "NSTACK",     IgnoreWithData,  false },
+	{ "NTG",        IgnoreWithData,  false },
+	{ "OIL",        IgnoreNoData,    false },
+	{ "PERMX",      FloatingPoint,   true  },
+	{ "PERMXX",     FloatingPoint,   true  },
+	{ "PERMXY",     FloatingPoint,   true  },
+	{ "PERMY",      FloatingPoint,   true  },
+	{ "PERMYY",     FloatingPoint,   true  },
+	{ "PERMYZ",     FloatingPoint,   true  },
+	{ "PERMZ",      FloatingPoint,   true  },
+	{ "PERMZX",     FloatingPoint,   true  },
+	{ "PERMZZ",     FloatingPoint,   true  },
+	{ "POISSONMOD", FloatingPoint,   true  },
+	{ "PORO",       FloatingPoint,   true  },
+	{ "PROPS",      IgnoreNoData,    false },
+	{ "PVDG",       SpecialField,    false },
+	{ "PVDO",       SpecialField,    false },
+	{ "PVTG",       SpecialField,    false },
+	{ "PVTO",       SpecialField,    false },
+	{ "PVTW",       SpecialField,    false },
+	{ "PWAVEMOD",   FloatingPoint,   true  },
+	{ "REGDIMS",    Integer,         false },
+	{ "REGIONS",    IgnoreNoData,    false },
+	{ "REGNUM",     Integer,         true  },
+	{ "ROCK",       SpecialField,    false },
+	{ "ROCKTAB",    SpecialField,    false },
+	{ "ROCKTYPE",   Integer,         true  },
+	{ "ROIP",       IgnoreWithData,  false },
+	{ "RPR",        IgnoreWithData,  false },
+	{ "RPTRST",     IgnoreWithData,  false },
+	{ "RUNSPEC",    IgnoreNoData,    false },
+	{ "RUNSUM",     IgnoreNoData,    false },
+	{ "RWIP",       IgnoreWithData,  false },
+	{ "RWSAT",      IgnoreWithData,  false },
+	{ "SATNUM",     Integer,         true  },
+	{ "SCHEDULE",   IgnoreNoData,    false },
+	{ "SGOF",       SpecialField,    false },
+	{ "SHEARMOD",   FloatingPoint,   true  },
+	{ "SOF2",       SpecialField,    false },
+	{ "SOLUTION",   IgnoreNoData,    false },
+	{ "SPECGRID",   SpecialField,    false },
+	{ "START",      SpecialField,    false },
+	{ "SUMMARY",    IgnoreNoData,    false },
+	{ "SWFN",       SpecialField,    false },
+	{ "SWOF",       SpecialField,    false },
+	{ "TABDIMS",    Integer,         false },
+	{ "TITLE",      SpecialField,    false },
+	{ "TSTEP",      IgnoreWithData,  false },
+	{ "TUNING",     SpecialField,    false },
+	{ "WATER",      IgnoreNoData,    false },
+	{ "WBHP",       IgnoreWithData,  false },
+	{ "WCONINJE",   SpecialField,    false },
+	{ "WELLDIMS",   Integer,         false },
+	{ "WELSPECS",   SpecialField,    false },
+	{ "WOIR",       IgnoreWithData,  false },
+	{ "YOUNGMOD",   FloatingPoint,   true  },
+	{ "ZCORN",      FloatingPoint,   false }
     };
+    const int num_keywords = sizeof(keyword_table) / sizeof(keyword_table[0]);
+
+    struct KeywordLess
+    {
+	bool operator()(const KeywordInfo& info, const char* name) const
+	{
+	    return std::strcmp(info.name, name) < 0;
+	}
+    };
+
+    // Returns the table entry of the given keyword, or null if the
+    // keyword is not supported.
+    inline const KeywordInfo* findKeyword(const string& keyword)
+    {
+	const KeywordInfo* end = keyword_table + num_keywords;
+	const KeywordInfo* info = std::lower_bound(keyword_table, end, keyword.c_str(), KeywordLess());
+	if (info != end && keyword == info->name) {
+	    return info;
+	}
+	return 0;
+    }
 
     inline FieldType classifyKeyword(const string& keyword)
     {
-	using namespace EclipseKeywords;
-	if (count(integer_fields, integer_fields + num_integer_fields, keyword)) {
-	    return Integer;
-	} else if (count(floating_fields, floating_fields + num_floating_fields, keyword)) {
-	    return FloatingPoint;
-	} else if (count(special_fields, special_fields + num_special_fields, keyword)) {
-	    return SpecialField;
-	} else if (count(ignore_with_data, ignore_with_data + num_ignore_with_data, keyword)) {
-	    return IgnoreWithData;
-	} else if (count(ignore_no_data, ignore_no_data + num_ignore_no_data, keyword)) {
-	    return IgnoreNoData;
-	} else if (count(include_keywords, include_keywords + num_include_keywords, keyword)) {
-	    return Include;
+	const KeywordInfo* info = findKeyword(keyword);
+	return info ? info->type : Unknown;
+    }
+
+    inline bool isCellField(const string& keyword)
+    {
+	const KeywordInfo* info = findKeyword(keyword);
+	return info && info->cell_field;
+    }
+
+    // Returns the number of values expected for a field, if it is
+    // known from grid dimensions (DIMENS or SPECGRID) read earlier,
+    // and zero otherwise. The size is computed in std::size_t, since
+    // it overflows int for large models.
+    std::size_t expectedFieldSize(const string& keyword,
+				  const map<string, vector<int> >& intmap,
+				  const map<string, boost::shared_ptr<SpecialBase> >& specialmap)
+    {
+	vector<int> dims;
+	map<string, vector<int> >::const_iterator dimens = intmap.find("DIMENS");
+	map<string, boost::shared_ptr<SpecialBase> >::const_iterator specgrid = specialmap.find("SPECGRID");
+	if (dimens != intmap.end() && dimens->second.size() >= 3) {
+	    dims = dimens->second;
+	} else if (specgrid != specialmap.end()) {
+	    dims = dynamic_cast<const SPECGRID&>(*specgrid->second).dimensions;
+	} else {
+	    return 0;
+	}
+	if (dims.size() < 3 || dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0) {
+	    return 0;
+	}
+	const std::size_t nx = dims[0];
+	const std::size_t ny = dims[1];
+	const std::size_t nz = dims[2];
+	if (keyword == "COORD") {
+	    return 6*(nx + 1)*(ny + 1);
+	} else if (keyword == "ZCORN") {
+	    return 8*nx*ny*nz;
+	} else if (isCellField(keyword)) {
+	    return nx*ny*nz;
+	}
+	return 0;
+    }
+
+    // ---------- Unformatted (binary) Eclipse files ----------
+
+    // Unformatted files (EGRID, INIT) are sequences of big-endian
+    // Fortran records, each enclosed by its length in bytes. Every
+    // array is a header record (8 character name, number of elements
+    // and 4 character type), followed by the elements split over as
+    // many records as needed.
+
+    inline boost::uint32_t bigEndian32(const char* p)
+    {
+	const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+	return (boost::uint32_t(u[0]) << 24) | (boost::uint32_t(u[1]) << 16)
+	    | (boost::uint32_t(u[2]) << 8) | boost::uint32_t(u[3]);
+    }
+
+    inline boost::uint64_t bigEndian64(const char* p)
+    {
+	return (boost::uint64_t(bigEndian32(p)) << 32) | bigEndian32(p + 4);
+    }
+
+    // Returns true if the data starts with an array header record.
+    bool isUnformattedEclipse(const char* data, size_t size)
+    {
+	return size >= 24 && bigEndian32(data) == 16 && bigEndian32(data + 20) == 16;
+    }
+
+    // Size in bytes of an element of the given type.
+    int elementSize(const string& type)
+    {
+	if (type == "INTE" || type == "REAL" || type == "LOGI") {
+	    return 4;
+	} else if (type == "DOUB" || type == "CHAR") {
+	    return 8;
+	} else if (type == "MESS") {
+	    return 0;
+	} else if (type.substr(0, 2) == "C0") {
+	    return std::atoi(type.c_str() + 1);
 	} else {
-	    return Unknown;
+	    THROW("Unknown array type " << type << " in unformatted Eclipse file.");
+	}
+    }
+
+    // Converts n big-endian numbers of the given type to T.
+    template <typename T>
+    void convertNumbers(const char* src, int n, const string& type, T* dst)
+    {
+	if (type == "INTE") {
+	    for (int i = 0; i < n; ++i) {
+		dst[i] = T(boost::int32_t(bigEndian32(src + 4*i)));
+	    }
+	} else if (type == "REAL") {
+	    for (int i = 0; i < n; ++i) {
+		boost::uint32_t bits = bigEndian32(src + 4*i);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		dst[i] = T(value);
+	    }
+	} else if (type == "DOUB") {
+	    for (int i = 0; i < n; ++i) {
+		boost::uint64_t bits = bigEndian64(src + 8*i);
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		dst[i] = T(value);
+	    }
+	} else {
+	    THROW("Expected numeric data in unformatted Eclipse file, found type " << type);
+	}
+    }
+
+    class UnformattedReader
+    {
+    public:
+	UnformattedReader(const char* data, size_t size)
+	    : pos_(data), end_(data + size)
+	{
+	}
+	bool atEnd() const
+	{
+	    return pos_ == end_;
+	}
+	void readHeader(string& keyword, int& count, string& type)
+	{
+	    const char* rec;
+	    if (nextRecord(rec) != 16) {
+		THROW("Expected array header in unformatted Eclipse file.");
+	    }
+	    keyword = string(rec, 8);
+	    keyword.erase(keyword.find_last_not_of(' ') + 1);
+	    count = bigEndian32(rec + 8);
+	    type = string(rec + 12, 4);
+	}
+	template <typename T>
+	void readArray(int count, const string& type, vector<T>& data)
+	{
+	    const int elem_size = elementSize(type);
+	    data.resize(count);
+	    int done = 0;
+	    while (done < count) {
+		const char* rec;
+		const int n = nextRecord(rec) / elem_size;
+		if (n == 0 || done + n > count) {
+		    THROW("Inconsistent record length in unformatted Eclipse file.");
+		}
+		convertNumbers(rec, n, type, &data[done]);
+		done += n;
+	    }
+	}
+	void skipArray(int count, const string& type)
+	{
+	    const int elem_size = elementSize(type);
+	    size_t bytes = size_t(count)*elem_size;
+	    while (bytes > 0) {
+		const char* rec;
+		const size_t len = nextRecord(rec);
+		if (len == 0 || len > bytes) {
+		    THROW("Inconsistent record length in unformatted Eclipse file.");
+		}
+		bytes -= len;
+	    }
+	}
+    private:
+	size_t nextRecord(const char*& rec)
+	{
+	    if (end_ - pos_ < 4) {
+		THROW("Unformatted Eclipse file is truncated.");
+	    }
+	    const size_t len = bigEndian32(pos_);
+	    if (size_t(end_ - pos_) < len + 8 || bigEndian32(pos_ + 4 + len) != len) {
+		THROW("Unformatted Eclipse file is truncated or corrupt.");
+	    }
+	    rec = pos_ + 4;
+	    pos_ += len + 8;
+	    return len;
+	}
+	const char* pos_;
+	const char* end_;
+    };
+
+    // Unformatted INIT files only store cell fields for the active
+    // cells. Expands such a field to all cells, using zero for the
+    // inactive cells.
+    template <typename T>
+    void expandActiveField(vector<T>& data, const vector<int>& actnum)
+    {
+	vector<T> all(actnum.size(), T(0));
+	int active = 0;
+	for (size_t cell = 0; cell < actnum.size(); ++cell) {
+	    if (actnum[cell]) {
+		all[cell] = data[active++];
+	    }
+	}
+	data.swap(all);
+    }
+
+    // Moves the fields of an included file into the target map,
+    // unless the main file sets the same keyword after the INCLUDE.
+    template <typename T>
+    void mergeIncludedFields(map<string, T>& target,
+			     map<string, T>& included,
+			     const map<string, int>& last_position,
+			     int include_position)
+    {
+	for (typename map<string, T>::iterator it = included.begin(); it != included.end(); ++it) {
+	    map<string, int>::const_iterator pos = last_position.find(it->first);
+	    if (pos == last_position.end() || pos->second < include_position) {
+		std::swap(target[it->first], it->second);
+	    }
 	}
     }
 
@@ -172,10 +501,20 @@ namespace {
 
 // ---------- Member functions ----------
 
+/// Default constructor, used for included files.
+//---------------------------------------------------------------------------
+EclipseGridParser::EclipseGridParser()
+//---------------------------------------------------------------------------
+    : parallel_includes_(false), lazy_(false), single_precision_(false)
+{
+}
+
+
 /// Constructor taking an eclipse file as a stream.
 //---------------------------------------------------------------------------
 EclipseGridParser::EclipseGridParser(istream& is)
 //---------------------------------------------------------------------------
+    : parallel_includes_(false), lazy_(false), single_precision_(false)
 {
     read(is);
 }
@@ -183,18 +522,195 @@ EclipseGridParser::EclipseGridParser(istream& is)
 
 /// Constructor taking an eclipse filename.
 //---------------------------------------------------------------------------
-EclipseGridParser::EclipseGridParser(const string& filename)
+EclipseGridParser::EclipseGridParser(const string& filename, int options)
 //---------------------------------------------------------------------------
+    : parallel_includes_((options & ParallelIncludes) && !(options & LazyFields)),
+      lazy_(options & LazyFields),
+      single_precision_(options & SinglePrecisionProperties)
 {
     // Store directory of filename
     boost::filesystem::path p(filename);
     directory_ = p.parent_path().string();
-    ifstream is(filename.c_str());
-    if (!is) {
+    if (!tryReadFile(filename)) {
 	cerr << "Unable to open file " << filename << endl;
 	throw exception();
     }
+}
+
+
+/// Read the given file, adding to any previous data.
+//---------------------------------------------------------------------------
+void EclipseGridParser::readFile(const string& filename)
+//---------------------------------------------------------------------------
+{
+    if (!tryReadFile(filename)) {
+	THROW("Unable to open file " << filename);
+    }
+}
+
+
+/// Read the given file, memory-mapped if possible. Returns false
+/// if the file could not be opened.
+//---------------------------------------------------------------------------
+bool EclipseGridParser::tryReadFile(const string& filename)
+//---------------------------------------------------------------------------
+{
+    boost::shared_ptr<MappedFileBuffer> mapped(new MappedFileBuffer(filename));
+    if (mapped->isOpen()) {
+	if (isUnformattedEclipse(mapped->data(), mapped->size())) {
+	    readUnformatted(mapped->data(), mapped->size());
+	} else {
+	    istream is(mapped.get());
+	    read(is);
+	    if (lazy_) {
+		// Lazy fields are read from the mapping later.
+		mapped_files_.push_back(mapped);
+	    }
+	}
+	return true;
+    }
+    vector<char> buffer(file_buffer_size);
+    ifstream is;
+    is.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+    is.open(filename.c_str());
+    if (!is) {
+	return false;
+    }
     read(is);
+    return true;
+}
+
+
+/// Read the given INCLUDEd files concurrently, and merge their
+/// fields in the order they would have been read sequentially.
+//---------------------------------------------------------------------------
+void EclipseGridParser::readIncludes(const vector<string>& filenames,
+				     const vector<int>& positions,
+				     const map<string, int>& last_position)
+//---------------------------------------------------------------------------
+{
+    // The parsers must be created serially, since their construction
+    // registers the special fields with the (global) factory.
+    // Known grid dimensions are passed on so that the included
+    // fields can be allocated up front.
+    const int num_files = filenames.size();
+    vector<boost::shared_ptr<EclipseGridParser> > parsers(num_files);
+    for (int i = 0; i < num_files; ++i) {
+	parsers[i].reset(new EclipseGridParser);
+	parsers[i]->directory_ = directory_;
+	parsers[i]->single_precision_ = single_precision_;
+	if (hasField("DIMENS")) {
+	    parsers[i]->integer_field_map_["DIMENS"] = getIntegerValue("DIMENS");
+	}
+	if (hasField("SPECGRID")) {
+	    parsers[i]->special_field_map_["SPECGRID"] = getSpecialValue("SPECGRID");
+	}
+    }
+
+    // Exceptions may not propagate out of the parallel region.
+    vector<string> errors(num_files);
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < num_files; ++i) {
+	try {
+	    if (!parsers[i]->tryReadFile(filenames[i])) {
+		errors[i] = "Unable to open INCLUDEd file " + filenames[i];
+	    }
+	} catch (const std::exception& e) {
+	    errors[i] = "Error reading INCLUDEd file " + filenames[i] + ": " + e.what();
+	}
+    }
+    for (int i = 0; i < num_files; ++i) {
+	if (!errors[i].empty()) {
+	    THROW(errors[i]);
+	}
+    }
+
+    for (int i = 0; i < num_files; ++i) {
+	mergeIncludedFields(integer_field_map_, parsers[i]->integer_field_map_, last_position, positions[i]);
+	mergeIncludedFields(floating_field_map_, parsers[i]->floating_field_map_, last_position, positions[i]);
+	mergeIncludedFields(single_field_map_, parsers[i]->single_field_map_, last_position, positions[i]);
+	mergeIncludedFields(special_field_map_, parsers[i]->special_field_map_, last_position, positions[i]);
+    }
+}
+
+
+/// Read the arrays of an unformatted EGRID or INIT file. Arrays
+/// that correspond to supported integer or floating point keywords
+/// are stored, the grid dimensions are stored as DIMENS, and all
+/// other arrays are skipped.
+//---------------------------------------------------------------------------
+void EclipseGridParser::readUnformatted(const char* data, size_t size)
+//---------------------------------------------------------------------------
+{
+    UnformattedReader reader(data, size);
+    int num_cells = -1;
+    while (!reader.atEnd()) {
+	string keyword;
+	string type;
+	int count;
+	reader.readHeader(keyword, count, type);
+	if (keyword == "ENDGRID") {
+	    // Local grid refinements and NNCs follow, which we do not support.
+	    break;
+	}
+	if (keyword == "GRIDHEAD" || keyword == "INTEHEAD") {
+	    vector<int> header;
+	    reader.readArray(count, type, header);
+	    const int first = (keyword == "GRIDHEAD") ? 1 : 8;
+	    if (int(header.size()) < first + 3) {
+		THROW("Too short " << keyword << " in unformatted Eclipse file.");
+	    }
+	    vector<int>& dims = integer_field_map_["DIMENS"];
+	    dims.assign(header.begin() + first, header.begin() + first + 3);
+	    num_cells = dims[0]*dims[1]*dims[2];
+	    continue;
+	}
+	FieldType field_type = classifyKeyword(keyword);
+	lazy_fields_.erase(keyword);
+	if (field_type == Integer) {
+	    vector<int>& field = integer_field_map_[keyword];
+	    reader.readArray(count, type, field);
+	    if (keyword != "ACTNUM" && isCellField(keyword) && count != num_cells) {
+		expandActiveField(field, activeCells(keyword, count, num_cells));
+	    }
+	} else if (field_type == FloatingPoint && single_precision_ && isCellField(keyword)) {
+	    floating_field_map_.erase(keyword);
+	    vector<float>& field = single_field_map_[keyword];
+	    reader.readArray(count, type, field);
+	    if (count != num_cells) {
+		expandActiveField(field, activeCells(keyword, count, num_cells));
+	    }
+	} else if (field_type == FloatingPoint) {
+	    single_field_map_.erase(keyword);
+	    vector<double>& field = floating_field_map_[keyword];
+	    reader.readArray(count, type, field);
+	    if (isCellField(keyword) && count != num_cells) {
+		expandActiveField(field, activeCells(keyword, count, num_cells));
+	    }
+	} else {
+	    reader.skipArray(count, type);
+	}
+    }
+}
+
+
+/// Returns ACTNUM, after checking that a cell field read from an
+/// unformatted file with the given number of values is given for
+/// exactly the active cells.
+//---------------------------------------------------------------------------
+const vector<int>& EclipseGridParser::activeCells(const string& keyword, int count, int num_cells) const
+//---------------------------------------------------------------------------
+{
+    const vector<int>& actnum = getIntegerValue("ACTNUM");
+    if (num_cells < 0 || int(actnum.size()) != num_cells) {
+	THROW("Field " << keyword << " is given for active cells only; "
+	      "read the grid (EGRID) file first.");
+    }
+    if (count != int(actnum.size()) - int(std::count(actnum.begin(), actnum.end(), 0))) {
+	THROW("Field " << keyword << " has " << count << " values, which matches neither "
+	      "the number of cells nor the number of active cells.");
+    }
+    return actnum;
 }
 
 
@@ -217,6 +733,24 @@ void EclipseGridParser::read(istream& is)
     map<string, vector<double> >& floatmap = floating_field_map_;
     map<string, boost::shared_ptr<SpecialBase> >& specialmap = special_field_map_;
 
+    // With parallel includes, INCLUDEd files are only recorded here,
+    // together with the position of every keyword in this stream,
+    // and read after the stream has been read.
+    vector<string> include_files;
+    vector<int> include_positions;
+    map<string, int> last_position;
+    int position = 0;
+
+    // In lazy mode, fields in memory-mapped files are only located
+    // here, and read on first access.
+    MappedFileBuffer* mapped = lazy_ ? dynamic_cast<MappedFileBuffer*>(is.rdbuf()) : 0;
+
+#define VERBOSE_PARSE_RATE 0
+#if VERBOSE_PARSE_RATE
+    time::StopWatch clock;
+    clock.start();
+#endif
+
     // Actually read the data
     is >> ignoreWhitespace;
     while (!is.eof()) {
@@ -225,12 +759,37 @@ void EclipseGridParser::read(istream& is)
 	cout << "Keyword found: " << keyword << endl;
 #endif
 	FieldType type = classifyKeyword(keyword);
+	// DIMENS is always read, since it gives the sizes of other fields.
+	if (mapped && (type == Integer || type == FloatingPoint) && keyword != "DIMENS") {
+	    LazyData& lazy = lazy_fields_[keyword];
+	    lazy.begin = mapped->position();
+	    lazy.end = mapped->data() + mapped->size();
+	    lazy.integer = (type == Integer);
+	    type = Deferred;
+	}
 	switch (type) {
 	case Integer:
-	    readVectorData(is, intmap[keyword]);
+	    lazy_fields_.erase(keyword);
+	    readVectorData(is, intmap[keyword], expectedFieldSize(keyword, intmap, specialmap));
+	    last_position[keyword] = position;
 	    break;
 	case FloatingPoint:
-	    readVectorData(is, floatmap[keyword]);
+	    lazy_fields_.erase(keyword);
+	    if (single_precision_ && isCellField(keyword)) {
+		floatmap.erase(keyword);
+		readVectorData(is, single_field_map_[keyword], expectedFieldSize(keyword, intmap, specialmap));
+	    } else {
+		single_field_map_.erase(keyword);
+		readVectorData(is, floatmap[keyword], expectedFieldSize(keyword, intmap, specialmap));
+	    }
+	    last_position[keyword] = position;
+	    break;
+	case Deferred:
+	    intmap.erase(keyword);
+	    floatmap.erase(keyword);
+	    single_field_map_.erase(keyword);
+	    skipVectorData(is);
+	    last_position[keyword] = position;
 	    break;
 	case SpecialField: {
 	    boost::shared_ptr<SpecialBase> sb_ptr = createSpecialField(is, keyword);
@@ -239,6 +798,7 @@ void EclipseGridParser::read(istream& is)
 	    } else {
 		THROW("Could not create field " << keyword);
 	    }
+	    last_position[keyword] = position;
 	    break;
 	}
 	case IgnoreWithData: {
@@ -261,11 +821,12 @@ void EclipseGridParser::read(istream& is)
             string include_filename;
             getline(is, include_filename, '\'');
             include_filename = directory_ + '/' + include_filename;
-            ifstream include_is(include_filename.c_str());
-            if (!include_is) {
+            if (parallel_includes_) {
+                include_files.push_back(include_filename);
+                include_positions.push_back(position);
+            } else if (!tryReadFile(include_filename)) {
                 THROW("Unable to open INCLUDEd file " << include_filename);
             }
-            read(include_is);
             is >> ignoreSlashLine;
             break;
         }
@@ -275,6 +836,18 @@ void EclipseGridParser::read(istream& is)
 	    throw exception();
 	}
 	is >> ignoreWhitespace;
+	++position;
+    }
+
+#if VERBOSE_PARSE_RATE
+    clock.stop();
+    const double secs = clock.secsSinceStart();
+    std::cout << "Read " << position << " keywords in " << secs << " s ("
+	      << position/secs << " keywords/s)" << std::endl;
+#endif
+
+    if (!include_files.empty()) {
+	readIncludes(include_files, include_positions, last_position);
     }
 
 #define VERBOSE_LIST_FIELDS 0
@@ -305,7 +878,8 @@ bool EclipseGridParser::hasField(const string& keyword) const
 {
     string ukey = upcase(keyword);
     return integer_field_map_.count(ukey) || floating_field_map_.count(ukey) ||
-	special_field_map_.count(ukey);
+	special_field_map_.count(ukey) || lazy_fields_.count(ukey) ||
+	single_field_map_.count(ukey);
 }
 
 
@@ -349,6 +923,18 @@ vector<string> EclipseGridParser::fieldNames() const
 	    names.push_back(it->first);
 	}
     }
+    {
+	map<string, LazyData>::const_iterator it = lazy_fields_.begin();
+	for (; it != lazy_fields_.end(); ++it) {
+	    names.push_back(it->first);
+	}
+    }
+    {
+	map<string, vector<float> >::const_iterator it = single_field_map_.begin();
+	for (; it != single_field_map_.end(); ++it) {
+	    names.push_back(it->first);
+	}
+    }
     return names;
 }
 
@@ -365,6 +951,7 @@ const std::vector<int>& EclipseGridParser::getIntegerValue(const std::string& ke
 	throw exception();
     }
 
+    readLazyField(keyword);
     map<string, vector<int> >::const_iterator it
 	= integer_field_map_.find(keyword);
     if (it == integer_field_map_.end()) {
@@ -378,6 +965,8 @@ const std::vector<int>& EclipseGridParser::getIntegerValue(const std::string& ke
 const std::vector<double>& EclipseGridParser::getFloatingPointValue(const std::string& keyword) const
 //---------------------------------------------------------------------------
 {
+    readLazyField(keyword);
+    readSingleField(keyword);
     map<string, vector<double> >::const_iterator it
 	= floating_field_map_.find(keyword);
     if (it == floating_field_map_.end()) {
@@ -400,6 +989,52 @@ const boost::shared_ptr<SpecialBase> EclipseGridParser::getSpecialValue(const st
     }
 }
 
+/// Reads the values of a field located in lazy mode, if the given
+/// keyword is such a field that has not been read yet.
+//---------------------------------------------------------------------------
+void EclipseGridParser::readLazyField(const std::string& keyword) const
+//---------------------------------------------------------------------------
+{
+    map<string, LazyData>::iterator it = lazy_fields_.find(keyword);
+    if (it == lazy_fields_.end()) {
+	return;
+    }
+    MemoryBuffer buffer(it->second.begin, it->second.end);
+    istream is(&buffer);
+    const std::size_t expected_size = expectedFieldSize(keyword, integer_field_map_, special_field_map_);
+    if (it->second.integer) {
+	readVectorData(is, integer_field_map_[keyword], expected_size);
+    } else {
+	readVectorData(is, floating_field_map_[keyword], expected_size);
+    }
+    lazy_fields_.erase(it);
+}
+
+/// Converts a field stored in single precision to double precision,
+/// if the given keyword is such a field.
+//---------------------------------------------------------------------------
+void EclipseGridParser::readSingleField(const std::string& keyword) const
+//---------------------------------------------------------------------------
+{
+    map<string, vector<float> >::iterator it = single_field_map_.find(keyword);
+    if (it == single_field_map_.end()) {
+	return;
+    }
+    floating_field_map_[keyword].assign(it->second.begin(), it->second.end());
+    single_field_map_.erase(it);
+}
+
+//---------------------------------------------------------------------------
+void EclipseGridParser::releaseField(const std::string& keyword)
+//---------------------------------------------------------------------------
+{
+    integer_field_map_.erase(keyword);
+    floating_field_map_.erase(keyword);
+    single_field_map_.erase(keyword);
+    special_field_map_.erase(keyword);
+    lazy_fields_.erase(keyword);
+}
+
 //---------------------------------------------------------------------------
 boost::shared_ptr<SpecialBase>
 EclipseGridParser::createSpecialField(std::istream& is,
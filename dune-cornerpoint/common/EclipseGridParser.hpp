@@ -71,12 +71,48 @@ public:
     /// the constructor taking a filename to process eclipse
     /// files with INCLUDEs.
     explicit EclipseGridParser(std::istream& is);
+
+    /// Options for reading files, to be combined with bitwise or.
+    enum ReadOption {
+	/// The files INCLUDEd by the given file are read concurrently
+	/// after the file itself. The resulting fields are the same
+	/// as when reading serially.
+	ParallelIncludes = 1,
+	/// The values of integer and floating point fields (except
+	/// DIMENS) in memory-mapped files are not read until they are
+	/// first asked for, so unused fields cost neither time nor
+	/// memory. The files are then kept mapped for the lifetime of
+	/// the parser, the first access of a field may throw on
+	/// malformed data, and INCLUDEs are always read serially.
+	LazyFields = 2,
+	/// Floating point cell fields (PORO, PERM*, ...) are stored in
+	/// single precision until they are first asked for, halving
+	/// their memory use until then.
+	SinglePrecisionProperties = 4
+    };
+
     /// Convenience constructor taking an eclipse filename.
-    explicit EclipseGridParser(const std::string& filename);
+    /// Both formatted (.grdecl) and unformatted (EGRID, INIT)
+    /// files are accepted, see readFile().
+    /// The file, and any files it INCLUDEs, are memory-mapped
+    /// and parsed in place when possible.
+    /// The options are a combination of ReadOption values.
+    /// With LazyFields or SinglePrecisionProperties, first access of
+    /// a field modifies the parser, so it must not be done
+    /// concurrently.
+    explicit EclipseGridParser(const std::string& filename, int options = 0);
 
     /// Read the given stream, overwriting any previous data.
     void read(std::istream& is);
 
+    /// Read the given file, adding its fields to those already read.
+    /// The file may also be an unformatted (binary) EGRID or INIT
+    /// file, which is recognized from its contents, so that the
+    /// properties of an INIT file can be added to the grid of an
+    /// EGRID file. Such files must be read in that order, since the
+    /// INIT file only stores values for the active cells.
+    void readFile(const std::string& filename);
+
     /// Returns true if the given keyword corresponds to a field that
     /// was found in the file.
     bool hasField(const std::string& keyword) const;
@@ -99,6 +135,11 @@ public:
     /// or floats.
     const boost::shared_ptr<SpecialBase> getSpecialValue(const std::string& keyword) const;
 
+    /// Removes the given field, freeing its memory. Use this to drop
+    /// large fields, such as ZCORN, once they have been used.
+    /// References to its values are invalidated.
+    void releaseField(const std::string& keyword);
+
     // This macro implements support for a special field keyword. It requires that a subclass
     // of SpecialBase exists, that has the same name as the keyword.
     // After using SPECIAL_FIELD(KEYWORD), the public member getKEYWORD will be available.
@@ -141,11 +182,35 @@ public:
 #undef SPECIAL_FIELD
 
 private:
+    EclipseGridParser();
+    bool tryReadFile(const std::string& filename);
+    void readUnformatted(const char* data, std::size_t size);
+    const std::vector<int>& activeCells(const std::string& keyword, int count, int num_cells) const;
+    void readLazyField(const std::string& keyword) const;
+    void readSingleField(const std::string& keyword) const;
+
+    // Location of the data of a field read in lazy mode.
+    struct LazyData
+    {
+	const char* begin;
+	const char* end;
+	bool integer;
+    };
+
+    void readIncludes(const std::vector<std::string>& filenames,
+		      const std::vector<int>& positions,
+		      const std::map<std::string, int>& last_position);
     boost::shared_ptr<SpecialBase> createSpecialField(std::istream& is, const std::string& fieldname);
 
     std::string directory_;
-    std::map<std::string, std::vector<int> > integer_field_map_;
-    std::map<std::string, std::vector<double> > floating_field_map_;
+    bool parallel_includes_;
+    bool lazy_;
+    bool single_precision_;
+    mutable std::map<std::string, std::vector<int> > integer_field_map_;
+    mutable std::map<std::string, std::vector<double> > floating_field_map_;
+    mutable std::map<std::string, std::vector<float> > single_field_map_;
+    mutable std::map<std::string, LazyData> lazy_fields_;
+    std::vector<boost::shared_ptr<std::streambuf> > mapped_files_;
     std::map<std::string, boost::shared_ptr<SpecialBase> >special_field_map_;
     std::vector<int> empty_integer_field_;
     std::vector<double> empty_floating_field_;
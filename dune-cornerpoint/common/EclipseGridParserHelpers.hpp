@@ -39,7 +39,11 @@
 #include <limits>
 #include <string>
 #include <istream>
+#include <sstream>
+#include <locale>
 #include <vector>
+#include <cstdlib>
+#include <boost/cstdint.hpp>
 #include <dune/common/ErrorMacros.hpp>
 #include "linInt.hpp"
 #include <boost/date_time/gregorian/gregorian.hpp>
@@ -114,40 +118,262 @@ namespace
         return string_candidate.substr(beg, len);
     }
 
+    // Reads numbers and tokens directly from a stream buffer,
+    // avoiding the locale-aware (and slow) operator>>() of the
+    // stream itself. Numbers are read like operator>>() would read
+    // them in the classic locale, and any sign read before failing
+    // is consumed, like operator>>() does.
+    class NumberScanner
+    {
+    public:
+	explicit NumberScanner(std::istream& is)
+	    : sb_(*is.rdbuf())
+	{
+	}
+
+	// Returns the next character without consuming it, or EOF.
+	int peek()
+	{
+	    return sb_.sgetc();
+	}
+
+	// Consumes the next character.
+	void ignore()
+	{
+	    sb_.sbumpc();
+	}
+
+	// Reads a floating point value. Returns false if the next
+	// token does not start with a number.
+	bool read(double& value)
+	{
+	    text_.clear();
+	    int c = skipWhitespace();
+	    bool negative = false;
+	    if (c == '+' || c == '-') {
+		negative = (c == '-');
+		text_ += char(c);
+		c = sb_.snextc();
+	    }
+	    // Collect up to 19 significant digits in mantissa, and
+	    // the power of ten to scale it with in exponent.
+	    boost::uint64_t mantissa = 0;
+	    int num_significant = 0;
+	    int exponent = 0;
+	    bool exact = true;
+	    bool any_digits = false;
+	    for (; isDigit(c); c = sb_.snextc()) {
+		text_ += char(c);
+		any_digits = true;
+		if (num_significant < 19) {
+		    mantissa = 10*mantissa + (c - '0');
+		    num_significant += (mantissa != 0);
+		} else {
+		    ++exponent;
+		    exact = false;
+		}
+	    }
+	    if (c == '.') {
+		text_ += char(c);
+		for (c = sb_.snextc(); isDigit(c); c = sb_.snextc()) {
+		    text_ += char(c);
+		    any_digits = true;
+		    if (num_significant < 19) {
+			mantissa = 10*mantissa + (c - '0');
+			num_significant += (mantissa != 0);
+			--exponent;
+		    } else {
+			exact = false;
+		    }
+		}
+	    }
+	    if (!any_digits) {
+		return false;
+	    }
+	    if (c == 'e' || c == 'E') {
+		text_ += char(c);
+		c = sb_.snextc();
+		bool negative_exp = false;
+		if (c == '+' || c == '-') {
+		    negative_exp = (c == '-');
+		    text_ += char(c);
+		    c = sb_.snextc();
+		}
+		if (!isDigit(c)) {
+		    THROW("Encountered format error while reading data values. Value = "
+			  << text_);
+		}
+		int exp_value = 0;
+		for (; isDigit(c); c = sb_.snextc()) {
+		    text_ += char(c);
+		    if (exp_value < 100000) {
+			exp_value = 10*exp_value + (c - '0');
+		    }
+		}
+		exponent += negative_exp ? -exp_value : exp_value;
+	    }
+	    // Fast path: the mantissa and the power of ten are both
+	    // exactly representable, so a single multiplication or
+	    // division gives the correctly rounded result. Otherwise,
+	    // convert the text read in the classic locale, since
+	    // strtod() would depend on the global C locale.
+	    static const double powers[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+					     1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+					     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	    if (exact && mantissa <= (boost::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+		value = double(mantissa);
+		value = exponent < 0 ? value/powers[-exponent] : value*powers[exponent];
+		if (negative) {
+		    value = -value;
+		}
+	    } else {
+		std::istringstream text(text_);
+		text.imbue(std::locale::classic());
+		if (!(text >> value)) {
+		    THROW("Encountered value out of range while reading data values. Value = "
+			  << text_);
+		}
+	    }
+	    return true;
+	}
+
+	// Reads a single precision value, rounded from the double
+	// precision value read.
+	bool read(float& value)
+	{
+	    double d;
+	    if (!read(d)) {
+		return false;
+	    }
+	    value = float(d);
+	    return true;
+	}
+
+	// Reads an integer value. Returns false if the next token
+	// does not start with a number.
+	bool read(int& value)
+	{
+	    int c = skipWhitespace();
+	    bool negative = false;
+	    if (c == '+' || c == '-') {
+		negative = (c == '-');
+		c = sb_.snextc();
+	    }
+	    if (!isDigit(c)) {
+		return false;
+	    }
+	    long result = 0;
+	    for (; isDigit(c); c = sb_.snextc()) {
+		result = 10*result + (c - '0');
+		if (result > std::numeric_limits<int>::max()) {
+		    THROW("Integer value out of range while reading data values.");
+		}
+	    }
+	    value = negative ? -result : result;
+	    return true;
+	}
+
+	// Reads the rest of the current whitespace-delimited token.
+	// Returns an empty string at end of input.
+	std::string token()
+	{
+	    std::string tok;
+	    for (int c = skipWhitespace(); c != eof() && !isSpace(c); c = sb_.snextc()) {
+		tok += char(c);
+	    }
+	    return tok;
+	}
+
+    private:
+	std::streambuf& sb_;
+	std::string text_; // Text of the number being read, reused between reads.
+
+	static int eof()
+	{
+	    return std::char_traits<char>::eof();
+	}
+	static bool isDigit(int c)
+	{
+	    return c >= '0' && c <= '9';
+	}
+	static bool isSpace(int c)
+	{
+	    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+	int skipWhitespace()
+	{
+	    int c = sb_.sgetc();
+	    while (isSpace(c)) {
+		c = sb_.snextc();
+	    }
+	    return c;
+	}
+    };
+
     // Reads data until '/' or an error is encountered.
+    // If given, expected_size is used to allocate data up front.
     template<typename T>
-    inline void readVectorData(std::istream& is, std::vector<T>& data)
+    inline void readVectorData(std::istream& is, std::vector<T>& data, std::size_t expected_size = 0)
     {
 	data.clear();
-	while (is) {
+	data.reserve(expected_size);
+	NumberScanner scanner(is);
+	while (true) {
 	    T candidate;
-	    is >> candidate;
-	    if (is.rdstate() & std::ios::failbit) {
-		is.clear(is.rdstate() & ~std::ios::failbit);
-		std::string dummy;
-		is >> dummy;
+	    if (scanner.read(candidate)) {
+		if (scanner.peek() == int('*')) {
+		    scanner.ignore(); // ignore the '*'
+		    int multiplier = int(candidate);
+		    if (!scanner.read(candidate)) {
+			THROW("Encountered error while reading data values.");
+		    }
+		    data.insert(data.end(), multiplier, candidate);
+		} else {
+		    data.push_back(candidate);
+		}
+	    } else {
+		std::string dummy = scanner.token();
 		if (dummy == "/") {
                     is >> ignoreLine;
 		    break;
+		} else if (dummy.empty()) {
+		    THROW("Encountered error while reading data values.");
 		} else if (dummy[0] == '-') {  // "comment test"
 		    is >> ignoreLine; // This line is a comment
 		} else {
                     THROW("Encountered format error while reading data values. Value = " << dummy);
 		}
-	    } else {
-		if (is.peek() == int('*')) {
-		    is.ignore(); // ignore the '*'
-		    int multiplier = int(candidate);
-		    is >> candidate;
-		    data.insert(data.end(), multiplier, candidate);
+	    }
+	}
+    }
+
+    // Skips data until '/', like readVectorData() does, but without
+    // reading the values. Used for fields that are read on demand.
+    inline void skipVectorData(std::istream& is)
+    {
+	std::streambuf& sb = *is.rdbuf();
+	bool token_start = true;
+	int c = sb.sgetc();
+	while (c != std::char_traits<char>::eof()) {
+	    if (c == '/') {
+		sb.sbumpc();
+		is >> ignoreLine;
+		return;
+	    }
+	    if (token_start && c == '-') {
+		c = sb.snextc();
+		if (!(c >= '0' && c <= '9') && c != '.') {
+		    is >> ignoreLine; // This line is a comment
+		    c = sb.sgetc();
 		} else {
-		    data.push_back(candidate);
+		    token_start = false;
 		}
+		continue;
 	    }
+	    token_start = (c == ' ' || c == '\n' || c == '\t' || c == '\r');
+	    c = sb.snextc();
 	}
-	if (!is) {
-	    THROW("Encountered error while reading data values.");
-	}
+	THROW("Encountered error while reading data values.");
     }
 
 
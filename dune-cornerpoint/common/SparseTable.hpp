@@ -50,7 +50,11 @@ namespace Dune
     /// as efficiently as possible.
     /// It is supposed to behave similarly to a vector of vectors.
     /// Its behaviour is similar to compressed row sparse matrices.
-    template <typename T>
+    /// \tparam T The type of the table data.
+    /// \tparam Index The integer type used for row numbers and data
+    ///               positions. A 64-bit type is needed if the table
+    ///               may hold 2^31 or more data elements.
+    template <typename T, typename Index = int>
     class SparseTable
     {
     public:
@@ -121,33 +125,33 @@ namespace Dune
         }
 
         /// Returns the number of rows in the table.
-        int size() const
+        Index size() const
         {
             return empty() ? 0 : row_start_.size() - 1;
         }
 
         /// Allocate storage for table of expected size
-        void reserve(int exptd_nrows, int exptd_ndata)
+        void reserve(Index exptd_nrows, Index exptd_ndata)
         {
             row_start_.reserve(exptd_nrows + 1);
             data_.reserve(exptd_ndata);
         }
 
-        /// Swap contents for other SparseTable<T>
-        void swap(SparseTable<T>& other)
+        /// Swap contents for other SparseTable<T, Index>
+        void swap(SparseTable& other)
         {
             row_start_.swap(other.row_start_);
             data_.swap(other.data_);
         }
 
         /// Returns the number of data elements.
-        int dataSize() const
+        Index dataSize() const
         {
             return data_.size();
         }
 
         /// Returns the size of a table row.
-        int rowSize(int row) const
+        Index rowSize(Index row) const
         {
             ASSERT(row >= 0 && row < size());
             return row_start_[row + 1] - row_start_[row];
@@ -165,7 +169,7 @@ namespace Dune
         typedef boost::iterator_range<T*>       mutable_row_type;
 
         /// Returns a row of the table.
-        row_type operator[](int row) const
+        row_type operator[](Index row) const
         {
             ASSERT(row >= 0 && row < size());
             const T* start_ptr = data_.empty() ? 0 : &data_[0];
@@ -173,7 +177,7 @@ namespace Dune
         }
 
         /// Returns a mutable row of the table.
-        mutable_row_type operator[](int row)
+        mutable_row_type operator[](Index row)
         {
             ASSERT(row >= 0 && row < size());
             T* start_ptr = data_.empty() ? 0 : &data_[0];
@@ -193,7 +197,7 @@ namespace Dune
 
             os << "Row starts = [";
             std::copy(row_start_.begin(), row_start_.end(),
-                      std::ostream_iterator<int>(os, " "));
+                      std::ostream_iterator<Index>(os, " "));
             os << "\b]\n";
 
             os << "Data values = [";
@@ -206,14 +210,14 @@ namespace Dune
         std::vector<T> data_;
         // Like in the compressed row sparse matrix format,
         // row_start_.size() is equal to the number of rows + 1.
-        std::vector<int> row_start_;
+        std::vector<Index> row_start_;
 
 	template <class IntegerIter>
 	void setRowStartsFromSizes(IntegerIter rowsize_beg, IntegerIter rowsize_end)
 	{
             // Since we do not store the row sizes, but cumulative row sizes,
             // we have to create the cumulative ones.
-            int num_rows = rowsize_end - rowsize_beg;
+            Index num_rows = rowsize_end - rowsize_beg;
             if (num_rows < 1) {
                 THROW("Must have at least one row. Got " << num_rows << " rows.");
             }
@@ -226,7 +230,7 @@ namespace Dune
             row_start_[0] = 0;
             std::partial_sum(rowsize_beg, rowsize_end, row_start_.begin() + 1);
             // Check that data_ and row_start_ match.
-            if (int(data_.size()) != row_start_.back()) {
+            if (Index(data_.size()) != row_start_.back()) {
                 THROW("End of row start indices different from data size.");
             }
 
@@ -0,0 +1,347 @@
+//===========================================================================
+//
+// File: eclipsegridparser_test.cpp
+//
+// Created: Sat Oct 17 15:31:08 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#define BOOST_TEST_DYN_LINK
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE EclipseGridParserTest
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <boost/cstdint.hpp>
+#include "../EclipseGridParser.hpp"
+
+using namespace Dune;
+
+namespace
+{
+    // Helpers for writing unformatted (big-endian Fortran record) files.
+    void writeBigEndian(std::ostream& os, boost::uint64_t value, int bytes)
+    {
+	for (int b = bytes - 1; b >= 0; --b) {
+	    os.put(char((value >> (8*b)) & 0xff));
+	}
+    }
+
+    void writeArrayHeader(std::ostream& os, const std::string& keyword, int count, const std::string& type)
+    {
+	writeBigEndian(os, 16, 4);
+	os << keyword << std::string(8 - keyword.size(), ' ');
+	writeBigEndian(os, count, 4);
+	os << type;
+	writeBigEndian(os, 16, 4);
+    }
+
+    // Writes the array in records of at most record_size elements.
+    void writeArray(std::ostream& os, const std::string& keyword, const std::vector<double>& data,
+		    const std::string& type, int record_size = 1000)
+    {
+	const int count = data.size();
+	writeArrayHeader(os, keyword, count, type);
+	const int elem_size = (type == "DOUB") ? 8 : 4;
+	for (int start = 0; start < count; start += record_size) {
+	    const int n = std::min(record_size, count - start);
+	    writeBigEndian(os, n*elem_size, 4);
+	    for (int i = start; i < start + n; ++i) {
+		if (type == "INTE") {
+		    writeBigEndian(os, boost::uint32_t(int(data[i])), 4);
+		} else if (type == "REAL") {
+		    float value = data[i];
+		    boost::uint32_t bits;
+		    std::memcpy(&bits, &value, sizeof(bits));
+		    writeBigEndian(os, bits, 4);
+		} else {
+		    boost::uint64_t bits;
+		    std::memcpy(&bits, &data[i], sizeof(bits));
+		    writeBigEndian(os, bits, 8);
+		}
+	    }
+	    writeBigEndian(os, n*elem_size, 4);
+	}
+    }
+} // anonymous namespace
+
+BOOST_AUTO_TEST_CASE(vector_data)
+{
+    std::istringstream is("-- A comment line\n"
+			  "ZCORN\n"
+			  "  1 2.5 -- trailing comment\n"
+			  "  3*0.25 1e2 -.5E-1 +7 2.5e+1/\n"
+			  "ACTNUM\n"
+			  "  2*1 0\n"
+			  "  -- Comment between the data\n"
+			  "  1 1 /\n"
+			  "PORO\n"
+			  "0.1 0.30000000000000004 123456789012345678901234 /\n");
+    EclipseGridParser parser(is);
+
+    const double zcorn[] = { 1.0, 2.5, 0.25, 0.25, 0.25, 100.0, -0.05, 7.0, 25.0 };
+    const std::vector<double>& z = parser.getFloatingPointValue("ZCORN");
+    BOOST_CHECK_EQUAL_COLLECTIONS(z.begin(), z.end(), zcorn, zcorn + sizeof(zcorn)/sizeof(zcorn[0]));
+
+    const int actnum[] = { 1, 1, 0, 1, 1 };
+    const std::vector<int>& a = parser.getIntegerValue("ACTNUM");
+    BOOST_CHECK_EQUAL_COLLECTIONS(a.begin(), a.end(), actnum, actnum + sizeof(actnum)/sizeof(actnum[0]));
+
+    // Values must be correctly rounded, also those that are not
+    // exactly representable.
+    const double poro[] = { 0.1, 0.30000000000000004, 123456789012345678901234.0 };
+    const std::vector<double>& p = parser.getFloatingPointValue("PORO");
+    BOOST_CHECK_EQUAL_COLLECTIONS(p.begin(), p.end(), poro, poro + sizeof(poro)/sizeof(poro[0]));
+}
+
+BOOST_AUTO_TEST_CASE(vector_data_errors)
+{
+    std::istringstream bad_value("PORO\n0.1 x0.2 /\n");
+    BOOST_CHECK_THROW(EclipseGridParser parser(bad_value), std::exception);
+    std::istringstream missing_slash("PORO\n0.1 0.2\n");
+    BOOST_CHECK_THROW(EclipseGridParser parser(missing_slash), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(keyword_classification)
+{
+    std::istringstream is("RUNSPEC\n"
+			  "MAPUNITS\n'METRES' /\n"
+			  "SATNUM\n2*3 /\n"
+			  "TITLE\nA title\n"
+			  "ECHO\n");
+    EclipseGridParser parser(is);
+    BOOST_CHECK(!parser.hasField("MAPUNITS"));
+    BOOST_CHECK(parser.hasField("TITLE"));
+    const std::vector<int>& satnum = parser.getIntegerValue("SATNUM");
+    BOOST_REQUIRE_EQUAL(satnum.size(), 2u);
+    BOOST_CHECK_EQUAL(satnum[1], 3);
+
+    std::istringstream unknown("PORO\n0.1 /\nNOSUCHKEYWORD\n");
+    BOOST_CHECK_THROW(EclipseGridParser parser(unknown), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(file_with_include)
+{
+    {
+	std::ofstream main_file("eclipsegridparser_test_main.grdecl");
+	main_file << "SPECGRID\n2 1 1 1 F /\n"
+		  << "INCLUDE\n'eclipsegridparser_test_include.grdecl' /\n"
+		  << "ACTNUM\n1 0 /\n";
+	std::ofstream include_file("eclipsegridparser_test_include.grdecl");
+	include_file << "ZCORN\n8*1.0 8*2.5 /\n";
+    }
+    EclipseGridParser parser("./eclipsegridparser_test_main.grdecl");
+    std::remove("eclipsegridparser_test_main.grdecl");
+    std::remove("eclipsegridparser_test_include.grdecl");
+
+    BOOST_CHECK(parser.hasField("SPECGRID"));
+    const std::vector<double>& z = parser.getFloatingPointValue("ZCORN");
+    BOOST_REQUIRE_EQUAL(z.size(), 16u);
+    BOOST_CHECK_EQUAL(z[7], 1.0);
+    BOOST_CHECK_EQUAL(z[8], 2.5);
+    const std::vector<int>& a = parser.getIntegerValue("ACTNUM");
+    BOOST_REQUIRE_EQUAL(a.size(), 2u);
+    BOOST_CHECK_EQUAL(a[1], 0);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_includes)
+{
+    {
+	std::ofstream main_file("eclipsegridparser_test_main.grdecl");
+	main_file << "DIMENS\n2 1 1 /\n"
+		  << "PORO\n2*0.1 /\n"
+		  << "INCLUDE\n'eclipsegridparser_test_a.grdecl' /\n"
+		  << "INCLUDE\n'eclipsegridparser_test_b.grdecl' /\n"
+		  << "PERMX\n2*100 /\n";
+	std::ofstream a_file("eclipsegridparser_test_a.grdecl");
+	a_file << "PORO\n2*0.2 /\nPERMY\n2*50 /\n";
+	std::ofstream b_file("eclipsegridparser_test_b.grdecl");
+	b_file << "PERMX\n2*10 /\nPERMY\n2*20 /\nACTNUM\n1 0 /\n";
+    }
+    EclipseGridParser serial("./eclipsegridparser_test_main.grdecl");
+    EclipseGridParser parallel("./eclipsegridparser_test_main.grdecl", EclipseGridParser::ParallelIncludes);
+    std::remove("eclipsegridparser_test_main.grdecl");
+    std::remove("eclipsegridparser_test_a.grdecl");
+    std::remove("eclipsegridparser_test_b.grdecl");
+
+    // Later keywords override earlier ones, whether they are in an
+    // included file or not.
+    BOOST_CHECK_EQUAL(parallel.getFloatingPointValue("PORO")[0], 0.2);
+    BOOST_CHECK_EQUAL(parallel.getFloatingPointValue("PERMX")[0], 100.0);
+    BOOST_CHECK_EQUAL(parallel.getFloatingPointValue("PERMY")[0], 20.0);
+
+    std::vector<std::string> names = serial.fieldNames();
+    std::vector<std::string> parallel_names = parallel.fieldNames();
+    BOOST_CHECK_EQUAL_COLLECTIONS(names.begin(), names.end(),
+				  parallel_names.begin(), parallel_names.end());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+	const std::vector<int>& si = serial.getIntegerValue(names[i]);
+	const std::vector<int>& pi = parallel.getIntegerValue(names[i]);
+	BOOST_CHECK_EQUAL_COLLECTIONS(si.begin(), si.end(), pi.begin(), pi.end());
+	const std::vector<double>& sf = serial.getFloatingPointValue(names[i]);
+	const std::vector<double>& pf = parallel.getFloatingPointValue(names[i]);
+	BOOST_CHECK_EQUAL_COLLECTIONS(sf.begin(), sf.end(), pf.begin(), pf.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(lazy_fields)
+{
+    {
+	std::ofstream main_file("eclipsegridparser_test_main.grdecl");
+	main_file << "DIMENS\n2 1 1 /\n"
+		  << "PORO\n1 2 / 3\n"
+		  << "PERMX\n2*100 -- Not the end / of data\n"
+		  << "-- Comment / line\n"
+		  << "  -.5 /\n"
+		  << "INCLUDE\n'eclipsegridparser_test_a.grdecl' /\n"
+		  << "ACTNUM\n1 0 /\n";
+	std::ofstream a_file("eclipsegridparser_test_a.grdecl");
+	a_file << "PORO\n2*0.2 /\nACTNUM\n2*1 /\n";
+    }
+    EclipseGridParser eager("./eclipsegridparser_test_main.grdecl");
+    EclipseGridParser lazy("./eclipsegridparser_test_main.grdecl", EclipseGridParser::LazyFields);
+    std::remove("eclipsegridparser_test_main.grdecl");
+    std::remove("eclipsegridparser_test_a.grdecl");
+
+    BOOST_CHECK(lazy.hasField("PERMX"));
+    BOOST_CHECK(!lazy.hasField("PERMY"));
+    std::vector<std::string> names = eager.fieldNames();
+    std::vector<std::string> lazy_names = lazy.fieldNames();
+    std::sort(lazy_names.begin(), lazy_names.end());
+    std::sort(names.begin(), names.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(names.begin(), names.end(),
+				  lazy_names.begin(), lazy_names.end());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+	const std::vector<int>& ei = eager.getIntegerValue(names[i]);
+	const std::vector<int>& li = lazy.getIntegerValue(names[i]);
+	BOOST_CHECK_EQUAL_COLLECTIONS(ei.begin(), ei.end(), li.begin(), li.end());
+	const std::vector<double>& ef = eager.getFloatingPointValue(names[i]);
+	const std::vector<double>& lf = lazy.getFloatingPointValue(names[i]);
+	BOOST_CHECK_EQUAL_COLLECTIONS(ef.begin(), ef.end(), lf.begin(), lf.end());
+    }
+    BOOST_CHECK_EQUAL(lazy.getFloatingPointValue("PERMX").size(), 3u);
+    BOOST_CHECK_EQUAL(lazy.getIntegerValue("ACTNUM")[1], 0);
+}
+
+BOOST_AUTO_TEST_CASE(unformatted_egrid_and_init)
+{
+    {
+	// A 2x1x1 grid, with one inactive cell.
+	std::ofstream egrid("eclipsegridparser_test.EGRID", std::ios::binary);
+	std::vector<double> gridhead(100, 0.0);
+	gridhead[0] = 1;
+	gridhead[1] = 2;
+	gridhead[2] = 1;
+	gridhead[3] = 1;
+	writeArray(egrid, "GRIDHEAD", gridhead, "INTE");
+	std::vector<double> coord(12);
+	for (int i = 0; i < 12; ++i) {
+	    coord[i] = 0.5*i;
+	}
+	writeArray(egrid, "COORD", coord, "REAL");
+	std::vector<double> zcorn(16, 1.0);
+	std::fill(zcorn.begin() + 8, zcorn.end(), 2.5);
+	writeArray(egrid, "ZCORN", zcorn, "REAL", 5);
+	std::vector<double> actnum(2, 1.0);
+	actnum[1] = 0.0;
+	writeArray(egrid, "ACTNUM", actnum, "INTE");
+	writeArray(egrid, "ENDGRID", std::vector<double>(), "INTE");
+	// Local grids following ENDGRID are ignored.
+	writeArray(egrid, "ZCORN", std::vector<double>(3, 7.0), "REAL");
+
+	// INIT files store cell fields for active cells only.
+	std::ofstream init("eclipsegridparser_test.INIT", std::ios::binary);
+	std::vector<double> intehead(95, 0.0);
+	intehead[8] = 2;
+	intehead[9] = 1;
+	intehead[10] = 1;
+	writeArray(init, "INTEHEAD", intehead, "INTE");
+	writeArray(init, "DEPTH", std::vector<double>(1, 1.75), "REAL");
+	writeArray(init, "PORO", std::vector<double>(1, 0.25), "REAL");
+	writeArray(init, "PERMX", std::vector<double>(1, 123.456), "DOUB");
+	writeArray(init, "SATNUM", std::vector<double>(1, 3.0), "INTE");
+    }
+    EclipseGridParser parser("./eclipsegridparser_test.EGRID");
+    parser.readFile("./eclipsegridparser_test.INIT");
+    std::remove("eclipsegridparser_test.EGRID");
+    std::remove("eclipsegridparser_test.INIT");
+
+    const int dimens[] = { 2, 1, 1 };
+    const std::vector<int>& d = parser.getIntegerValue("DIMENS");
+    BOOST_CHECK_EQUAL_COLLECTIONS(d.begin(), d.end(), dimens, dimens + 3);
+    const std::vector<double>& c = parser.getFloatingPointValue("COORD");
+    BOOST_REQUIRE_EQUAL(c.size(), 12u);
+    BOOST_CHECK_EQUAL(c[11], 5.5);
+    const std::vector<double>& z = parser.getFloatingPointValue("ZCORN");
+    BOOST_REQUIRE_EQUAL(z.size(), 16u);
+    BOOST_CHECK_EQUAL(z[7], 1.0);
+    BOOST_CHECK_EQUAL(z[8], 2.5);
+    const std::vector<int>& a = parser.getIntegerValue("ACTNUM");
+    BOOST_REQUIRE_EQUAL(a.size(), 2u);
+    BOOST_CHECK_EQUAL(a[1], 0);
+
+    BOOST_CHECK(!parser.hasField("DEPTH"));
+    const std::vector<double>& poro = parser.getFloatingPointValue("PORO");
+    BOOST_REQUIRE_EQUAL(poro.size(), 2u);
+    BOOST_CHECK_EQUAL(poro[0], 0.25);
+    BOOST_CHECK_EQUAL(poro[1], 0.0);
+    BOOST_CHECK_EQUAL(parser.getFloatingPointValue("PERMX")[0], 123.456);
+    const std::vector<int>& satnum = parser.getIntegerValue("SATNUM");
+    BOOST_REQUIRE_EQUAL(satnum.size(), 2u);
+    BOOST_CHECK_EQUAL(satnum[0], 3);
+}
+
+BOOST_AUTO_TEST_CASE(single_precision_and_release)
+{
+    {
+	std::ofstream main_file("eclipsegridparser_test_main.grdecl");
+	main_file << "DIMENS\n2 1 1 /\n"
+		  << "ZCORN\n8*0.1 8*0.3 /\n"
+		  << "PORO\n0.1 0.3 /\n";
+    }
+    EclipseGridParser parser("./eclipsegridparser_test_main.grdecl",
+			     EclipseGridParser::SinglePrecisionProperties);
+    std::remove("eclipsegridparser_test_main.grdecl");
+
+    // Only cell fields are rounded to single precision.
+    BOOST_CHECK(parser.hasField("PORO"));
+    BOOST_CHECK_EQUAL(parser.getFloatingPointValue("ZCORN")[8], 0.3);
+    const std::vector<double>& poro = parser.getFloatingPointValue("PORO");
+    BOOST_REQUIRE_EQUAL(poro.size(), 2u);
+    BOOST_CHECK_EQUAL(poro[1], double(0.3f));
+
+    parser.releaseField("ZCORN");
+    BOOST_CHECK(!parser.hasField("ZCORN"));
+    BOOST_CHECK(parser.getFloatingPointValue("ZCORN").empty());
+    BOOST_CHECK(parser.hasField("PORO"));
+}
@@ -40,6 +40,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "../SparseTable.hpp"
+#include <boost/cstdint.hpp>
 
 using namespace Dune;
 
@@ -126,3 +127,28 @@ BOOST_AUTO_TEST_CASE(construction_and_queries)
     BOOST_CHECK_THROW(const SparseTable<int> st6(elem, elem + num_elem, err_rs, err_rs + num_rows), std::exception);
 #endif
 }
+
+
+BOOST_AUTO_TEST_CASE(wide_index)
+{
+    typedef SparseTable<int, boost::int64_t> Table;
+    const int num_elem = 10;
+    const int elem[num_elem] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    const int num_rows = 5;
+    const int rowsizes[num_rows] = { 1, 0, 2, 4, 3 };
+    const Table st(elem, elem + num_elem, rowsizes, rowsizes + num_rows);
+    const SparseTable<int> st_int(elem, elem + num_elem, rowsizes, rowsizes + num_rows);
+    BOOST_CHECK_EQUAL(st.size(), num_rows);
+    BOOST_CHECK_EQUAL(st.dataSize(), num_elem);
+    for (int i = 0; i < num_rows; ++i) {
+        BOOST_CHECK_EQUAL(st.rowSize(i), st_int.rowSize(i));
+        BOOST_CHECK_EQUAL_COLLECTIONS(st[i].begin(), st[i].end(),
+                                      st_int[i].begin(), st_int[i].end());
+    }
+    Table st_append;
+    st_append.appendRow(elem, elem + 3);
+    st_append.appendRow(elem + 3, elem + num_elem);
+    BOOST_CHECK_EQUAL(st_append.size(), 2);
+    BOOST_CHECK_EQUAL(st_append.rowSize(1), num_elem - 3);
+    BOOST_CHECK_EQUAL(st_append[1][0], 3);
+}
@@ -49,6 +49,7 @@
 #include <dune/common/array.hh>
 
 #include <boost/array.hpp>
+#include <boost/cstdint.hpp>
 
 #include "cpgrid/Entity.hpp"
 #include "cpgrid/Geometry.hpp"
@@ -56,6 +57,7 @@
 #include "cpgrid/Iterators.hpp"
 #include "cpgrid/Indexsets.hpp"
 #include "cpgrid/DefaultGeometryPolicy.hpp"
+#include "cpgrid/HalfFace.hpp"
 #include "preprocess/preprocess.h"
 
 
@@ -183,6 +185,16 @@ namespace Dune
 	/// Family typedef, why is this not defined by Grid<>?
 	typedef CpGridFamily GridFamily;
 
+	/// Orderings of the cells of a processed grid.
+	enum CellOrdering {
+	    /// The Cartesian order of the active cells (default).
+	    CartesianOrdering,
+	    /// Reverse Cuthill-McKee order of the cell neighbour graph.
+	    ReverseCuthillMcKeeOrdering,
+	    /// Order along a Hilbert curve through the cell centroids.
+	    HilbertOrdering
+	};
+
 
 	// --- Methods ---
 
@@ -190,7 +202,8 @@ namespace Dune
 	/// Default constructor
 	CpGrid()
 	    : index_set_(*this), id_set_(*this),
-              use_unique_boundary_ids_(false)
+              use_unique_boundary_ids_(false),
+	      cell_ordering_(CartesianOrdering)
 	{
 	}
 
@@ -209,6 +222,18 @@ namespace Dune
 	/// found in <grid_prefix>-topo.dat etc.
         void writeSintefLegacyFormat(const std::string& grid_prefix) const;
 
+	/// Write the grid in a versioned binary format, for fast reloading.
+	/// All topology and geometry is stored as flat arrays in native
+	/// byte order, so the file is not meant for exchange between machines.
+	/// \param filename the name of the file to write.
+	void writeBinary(const std::string& filename) const;
+
+	/// Read a grid written by writeBinary(). The file is memory-mapped
+	/// and copied directly into the grid's structures, without any
+	/// preprocessing.
+	/// \param filename the name of the file to read.
+	void readBinary(const std::string& filename);
+
 	/// Read the Eclipse grid format ('grdecl').
 	/// \param filename the name of the file to read.
 	/// \param z_tolerance points along a pillar that are closer together in z
@@ -277,6 +302,51 @@ namespace Dune
             ijk[2] = gc / cartDims_[1];
         }
 
+	// --- Raw intersection interface ---
+
+	/// A range of half faces, see cpgrid::HalfFace.
+	typedef SparseTable<cpgrid::HalfFace, cpgrid::IndexType>::row_type HalfFaceRange;
+
+	/// The half faces of a cell, in the same order as its intersections.
+	/// Loops that only need neighbour and face information should use
+	/// this instead of the intersection iterators, which also build a
+	/// face geometry for every intersection.
+	/// This function is not part of the Dune grid interface.
+	HalfFaceRange halfFaces(int cell) const
+	{
+	    return half_faces_[cell];
+	}
+
+	/// The unit normal of a half face, pointing out of its cell.
+	FieldVector<double, 3> outerNormal(const cpgrid::HalfFace& hf) const
+	{
+	    return face_normals_[cpgrid::EntityRep<1>(hf.face, hf.orientation)];
+	}
+
+	/// The area of a face.
+	double faceArea(int face) const
+	{
+	    return geometry_.faceAreas()[face];
+	}
+
+	/// The centroid of a face.
+	FieldVector<double, 3> faceCentroid(int face) const
+	{
+	    return geometry_.faceCentroid(face);
+	}
+
+	/// The volume of a cell.
+	double cellVolume(int cell) const
+	{
+	    return geometry_.cellVolumes()[cell];
+	}
+
+	/// The centroid of a cell.
+	FieldVector<double, 3> cellCentroid(int cell) const
+	{
+	    return geometry_.cellCentroid(cell);
+	}
+
 	/// Is the grid currently using unique boundary ids?
 	/// \return true if each boundary intersection has a unique id
 	///         false if we use the (default) 1-6 ids for i- i+ j- j+ k- k+ boundaries.
@@ -295,6 +365,41 @@ namespace Dune
 	    }
 	}
 
+	/// Set a directory for caching processed Eclipse grids.
+	/// When set, processEclipseFormat() looks for a grid processed
+	/// earlier from identical COORD, ZCORN and ACTNUM data and
+	/// options, and loads it instead of processing the input again.
+	/// Newly processed grids are stored there in the binary format.
+	/// \param cache_dir an existing directory, or empty to disable caching.
+	void setGridCacheDirectory(const std::string& cache_dir)
+	{
+	    grid_cache_dir_ = cache_dir;
+	}
+
+	/// The grid cache directory, empty if caching is disabled.
+	const std::string& gridCacheDirectory() const
+	{
+	    return grid_cache_dir_;
+	}
+
+	/// Set the cell ordering used when processing Eclipse grids.
+	/// With an ordering other than CartesianOrdering, cells are
+	/// renumbered so that neighbouring cells are close in memory,
+	/// and faces and points are numbered in the order they appear
+	/// in the renumbered cells. globalCell() still maps each cell
+	/// to its Cartesian index.
+	/// \param ordering the cell ordering.
+	void setCellOrdering(CellOrdering ordering)
+	{
+	    cell_ordering_ = ordering;
+	}
+
+	/// The cell ordering used when processing Eclipse grids.
+	CellOrdering cellOrdering() const
+	{
+	    return cell_ordering_;
+	}
+
 	// --- Dune interface below ---
 
 
@@ -402,7 +507,7 @@ namespace Dune
 	    case 0: return cell_to_face_.size();
 	    case 1: return 0;
 	    case 2: return 0;
-	    case 3: return geomVector<3>().size();
+	    case 3: return geometry_.size<3>();
 	    default: return 0;
 	    }
         }
@@ -605,7 +710,8 @@ namespace Dune
 	// Representing the topology
 	cpgrid::OrientedEntityTable<0, 1> cell_to_face_;
 	cpgrid::OrientedEntityTable<1, 0> face_to_cell_;
-	SparseTable<int> face_to_point_;
+	SparseTable<cpgrid::HalfFace, cpgrid::IndexType> half_faces_;
+	SparseTable<int, cpgrid::IndexType> face_to_point_;
 	std::vector< array<int,8> > cell_to_point_;
 	boost::array<int, 3> logical_cartesian_size_;
         std::vector<int>                  global_cell_;
@@ -618,23 +724,41 @@ namespace Dune
 	Geom geometry_;
 	typedef FieldVector<ctype, 3> PointType;
 	cpgrid::SignedEntityVariable<PointType, 1> face_normals_;
-	std::vector<PointType> allcorners_; // Yes, this is already stored in the point geometries. \TODO Improve.
 	// Boundary information (optional).
 	bool use_unique_boundary_ids_;
 	cpgrid::EntityVariable<int, 1> unique_boundary_ids_;
+	// Directory for cached processed grids (optional).
+	std::string grid_cache_dir_;
+	// Ordering of the cells of processed grids.
+	CellOrdering cell_ordering_;
 
 	// --------- Methods ---------
 
-	// Return the geometry vector corresponding to the given codim.
+	// Return the geometry of the given entity, made from the stored geometry arrays.
 	template <int codim>
-	const cpgrid::EntityVariable< cpgrid::Geometry<3 - codim, 3, CpGrid>, codim>& geomVector() const
+	cpgrid::Geometry<3 - codim, 3, CpGrid> entityGeometry(const cpgrid::EntityRep<codim>& e) const
 	{
-	    return geometry_.geomVector<codim>();
+	    const int* corners = codim == 0 ? &cell_to_point_[e.index()][0] : 0;
+	    return geometry_.geometry<codim>(e.index(), corners);
 	}
 
 	// Make unique boundary ids for all intersections.
 	void computeUniqueBoundaryIds();
 
+	// Make the half face table from cell_to_face_ and face_to_cell_.
+	void computeHalfFaces();
+
+	// Renumber cells, faces and points according to cell_ordering_.
+	void applyCellOrdering();
+
+	// Build the grid from preprocessed data, releasing them.
+	void buildFromProcessedGrid(processed_grid& output, bool remove_ij_boundary, bool turn_normals);
+
+	// Write or read the binary format with a two-word grid cache key
+	// in the header. When reading, a non-null key must match the stored one.
+	void writeBinaryFile(const std::string& filename, const boost::uint64_t* cache_key) const;
+	void readBinaryFile(const std::string& filename, const boost::uint64_t* cache_key);
+
     }; // end Class CpGrid
 
 
@@ -50,14 +50,29 @@ namespace Dune
     void CpGrid::init(const parameter::ParameterGroup& param)
     {
 	std::string fileformat = param.get<std::string>("fileformat");
+	// The cell ordering applies to the eclipse and cartesian formats.
+	std::string ordering = param.getDefault<std::string>("cell_ordering", "cartesian");
+	if (ordering == "cartesian") {
+	    setCellOrdering(CartesianOrdering);
+	} else if (ordering == "rcm") {
+	    setCellOrdering(ReverseCuthillMcKeeOrdering);
+	} else if (ordering == "hilbert") {
+	    setCellOrdering(HilbertOrdering);
+	} else {
+	    THROW("Unknown cell ordering string: " << ordering);
+	}
 	if (fileformat == "sintef_legacy") {
 	    std::string grid_prefix = param.get<std::string>("grid_prefix");
 	    readSintefLegacyFormat(grid_prefix);
+	} else if (fileformat == "binary") {
+	    std::string filename = param.get<std::string>("filename");
+	    readBinary(filename);
 	} else if (fileformat == "eclipse") {
 	    std::string filename = param.get<std::string>("filename");
 	    double z_tolerance = param.getDefault<double>("z_tolerance", 0.0);
 	    bool periodic_extension = param.getDefault<bool>("periodic_extension", false);
 	    bool turn_normals = param.getDefault<bool>("turn_normals", false);
+	    setGridCacheDirectory(param.getDefault<std::string>("grid_cache_dir", grid_cache_dir_));
 	    readEclipseFormat(filename, z_tolerance, periodic_extension, turn_normals);
 	} else if (fileformat == "cartesian") {
 	    array<int, 3> dims = {{ param.getDefault<int>("nx", 1),
@@ -146,4 +161,33 @@ namespace Dune
 
 
 
+
+
+    void CpGrid::computeHalfFaces()
+    {
+	const int num_cells = cell_to_face_.size();
+	std::vector<cpgrid::HalfFace> hfaces;
+	std::vector<int> row_sizes(num_cells);
+	hfaces.reserve(cell_to_face_.dataSize());
+	for (int c = 0; c < num_cells; ++c) {
+	    cpgrid::OrientedEntityTable<0, 1>::row_type faces = cell_to_face_[cpgrid::EntityRep<0>(c, true)];
+	    row_sizes[c] = faces.size();
+	    for (int i = 0; i < faces.size(); ++i) {
+		cpgrid::OrientedEntityTable<1, 0>::row_type cells = face_to_cell_[faces[i]];
+		cpgrid::HalfFace hf;
+		hf.face = faces[i].index();
+		hf.orientation = faces[i].orientation();
+		hf.boundary = (cells.size() == 1);
+		if (hf.boundary) {
+		    hf.neighbour = -1;
+		} else {
+		    ASSERT(cells.size() == 2);
+		    hf.neighbour = (cells[0].index() == c) ? cells[1].index() : cells[0].index();
+		}
+		hfaces.push_back(hf);
+	    }
+	}
+	half_faces_.assign(hfaces.begin(), hfaces.end(), row_sizes.begin(), row_sizes.end());
+    }
+
 } // namespace Dune
@@ -36,7 +36,9 @@ along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef OPENRS_DEFAULTGEOMETRYPOLICY_HEADER
 #define OPENRS_DEFAULTGEOMETRYPOLICY_HEADER
 
+#include <vector>
 #include <boost/mpl/if.hpp>
+#include <boost/static_assert.hpp>
 #include "Geometry.hpp"
 #include "EntityRep.hpp"
 
@@ -49,99 +51,198 @@ namespace Dune
 	struct GetFaceGeom;
 	struct GetPointGeom;
 
-	/// @brief
-	/// @todo Doc me!
+	/// @brief Stores the geometry of the cells, faces and points of
+	/// a grid, and makes Geometry objects from it on demand.
+	///
+	/// The data are kept as a structure of arrays: the x, y and z
+	/// coordinates of the cell and face centroids, the cell volumes
+	/// and the face areas each have a contiguous array, so that sweeps
+	/// over one quantity touch only that quantity. The points are
+	/// stored once, and are also the corners of the cell geometries.
 	template <class GridType>
 	class DefaultGeometryPolicy
 	{
 	public:
-	    /// @brief
-	    /// @todo Doc me
+	    typedef FieldVector<double, 3> PointType;
+
+	    /// @brief Default constructor, yielding no entities.
 	    DefaultGeometryPolicy()
 	    {
 	    }
 
-	    /// @brief
-	    /// @todo Doc me
-	    /// @param
-	    DefaultGeometryPolicy(const EntityVariable<cpgrid::Geometry<3, 3, GridType>, 0>& cell_geom,
-				  const EntityVariable<cpgrid::Geometry<2, 3, GridType>, 1>& face_geom,
-				  const EntityVariable<cpgrid::Geometry<0, 3, GridType>, 3>& point_geom)
-		: cell_geom_(cell_geom), face_geom_(face_geom), point_geom_(point_geom)
+	    /// @brief Sets the number of cells, faces and points.
+	    /// The values of new entities are zero.
+	    void resize(int num_cells, int num_faces, int num_points)
+	    {
+		for (int dd = 0; dd < 3; ++dd) {
+		    cell_centroids_[dd].resize(num_cells);
+		    face_centroids_[dd].resize(num_faces);
+		}
+		cell_volumes_.resize(num_cells);
+		face_areas_.resize(num_faces);
+		points_.resize(num_points);
+	    }
+
+	    /// @brief Sets the centroid and volume of a cell.
+	    void setCell(int cell, const PointType& centroid, double volume)
+	    {
+		for (int dd = 0; dd < 3; ++dd) {
+		    cell_centroids_[dd][cell] = centroid[dd];
+		}
+		cell_volumes_[cell] = volume;
+	    }
+
+	    /// @brief Sets the centroid and area of a face.
+	    void setFace(int face, const PointType& centroid, double area)
+	    {
+		for (int dd = 0; dd < 3; ++dd) {
+		    face_centroids_[dd][face] = centroid[dd];
+		}
+		face_areas_[face] = area;
+	    }
+
+	    /// @brief The point positions, which may be modified.
+	    std::vector<PointType>& points()
+	    {
+		return points_;
+	    }
+
+	    /// @brief The point positions.
+	    const std::vector<PointType>& points() const
+	    {
+		return points_;
+	    }
+
+	    /// @brief The coordinate dd (0, 1 or 2) of all cell centroids.
+	    const std::vector<double>& cellCentroids(int dd) const
+	    {
+		return cell_centroids_[dd];
+	    }
+
+	    /// @brief The volumes of all cells.
+	    const std::vector<double>& cellVolumes() const
+	    {
+		return cell_volumes_;
+	    }
+
+	    /// @brief The coordinate dd (0, 1 or 2) of all face centroids.
+	    const std::vector<double>& faceCentroids(int dd) const
+	    {
+		return face_centroids_[dd];
+	    }
+
+	    /// @brief The areas of all faces.
+	    const std::vector<double>& faceAreas() const
+	    {
+		return face_areas_;
+	    }
+
+	    /// @brief The centroid of a cell.
+	    PointType cellCentroid(int cell) const
+	    {
+		PointType c;
+		for (int dd = 0; dd < 3; ++dd) {
+		    c[dd] = cell_centroids_[dd][cell];
+		}
+		return c;
+	    }
+
+	    /// @brief The centroid of a face.
+	    PointType faceCentroid(int face) const
+	    {
+		PointType c;
+		for (int dd = 0; dd < 3; ++dd) {
+		    c[dd] = face_centroids_[dd][face];
+		}
+		return c;
+	    }
+
+	    /// @brief The number of entities of the given codim (0, 1 or 3).
+	    template <int codim>
+	    int size() const
 	    {
+		BOOST_STATIC_ASSERT(codim != 2);
+		return codim == 0 ? cell_volumes_.size()
+		    : (codim == 1 ? face_areas_.size() : points_.size());
 	    }
 
-	    /// @brief
-	    /// @todo Doc me!
-	    /// @tparam
-	    /// @param
-	    /// @return
+	    /// @brief Makes the geometry of an entity.
+	    /// @tparam codim Codimension of the entity (0, 1 or 3).
+	    /// @param index Index of the entity.
+	    /// @param corner_indices For cells, the indices of the eight
+	    ///        corner points of the cell, which must outlive the
+	    ///        returned geometry. Unused for other codims.
+	    /// @return The geometry, referring to the points of this policy
+	    ///         for cells.
 	    template <int codim>
-	    const EntityVariable<cpgrid::Geometry<3 - codim, 3, GridType>, codim>& geomVector() const
+	    cpgrid::Geometry<3 - codim, 3, GridType> geometry(int index, const int* corner_indices = 0) const
 	    {
 		BOOST_STATIC_ASSERT(codim != 2);
 		typedef typename boost::mpl::if_c<codim == 0, GetCellGeom, 
 		    typename boost::mpl::if_c<codim == 1, GetFaceGeom, GetPointGeom>::type >::type selector;
-		return selector::value(*this);
+		return selector::value(*this, index, corner_indices);
 	    }
+
+	    /// @brief Exchanges the contents with another policy, without copying.
+	    void swap(DefaultGeometryPolicy& other)
+	    {
+		for (int dd = 0; dd < 3; ++dd) {
+		    cell_centroids_[dd].swap(other.cell_centroids_[dd]);
+		    face_centroids_[dd].swap(other.face_centroids_[dd]);
+		}
+		cell_volumes_.swap(other.cell_volumes_);
+		face_areas_.swap(other.face_areas_);
+		points_.swap(other.points_);
+	    }
+
 	private:
 	    friend class GetCellGeom;
 	    friend class GetFaceGeom;
 	    friend class GetPointGeom;
-	    EntityVariable<cpgrid::Geometry<3, 3, GridType>, 0> cell_geom_;
-	    EntityVariable<cpgrid::Geometry<2, 3, GridType>, 1> face_geom_;
-	    EntityVariable<cpgrid::Geometry<0, 3, GridType>, 3> point_geom_;
+	    std::vector<double> cell_centroids_[3];
+	    std::vector<double> cell_volumes_;
+	    std::vector<double> face_centroids_[3];
+	    std::vector<double> face_areas_;
+	    std::vector<PointType> points_;
 	};
 
-	/// @brief
-	/// @todo Doc me!
+	/// @brief Makes cell geometries for DefaultGeometryPolicy.
 	struct GetCellGeom
 	{
-	    
-	    /// @brief
-	    /// @todo Doc me!
-	    /// @tparam
-	    /// @param
-	    /// @return
+	    /// @brief Makes the geometry of the given cell.
 	    template <class GridType>
-	    static const EntityVariable<cpgrid::Geometry<3, 3, GridType>, 0>&
-	    value(const DefaultGeometryPolicy<GridType>& geom)
+	    static cpgrid::Geometry<3, 3, GridType>
+	    value(const DefaultGeometryPolicy<GridType>& geom, int cell, const int* corner_indices)
 	    {
-		return geom.cell_geom_;
+		return cpgrid::Geometry<3, 3, GridType>(geom.cellCentroid(cell),
+							 geom.cell_volumes_[cell],
+							 &geom.points_[0],
+							 corner_indices);
 	    }
 	};
 
-	/// @brief
-	/// @todo Doc me!
+	/// @brief Makes face geometries for DefaultGeometryPolicy.
 	struct GetFaceGeom
 	{
-	    /// @brief
-	    /// @todo Doc me!
-	    /// @tparam
-	    /// @param
-	    /// @return
+	    /// @brief Makes the geometry of the given face.
 	    template <class GridType>
-	    static const EntityVariable<cpgrid::Geometry<2, 3, GridType>, 1>&
-	    value(const DefaultGeometryPolicy<GridType>& geom)
+	    static cpgrid::Geometry<2, 3, GridType>
+	    value(const DefaultGeometryPolicy<GridType>& geom, int face, const int*)
 	    {
-		return geom.face_geom_;
+		return cpgrid::Geometry<2, 3, GridType>(geom.faceCentroid(face),
+							 geom.face_areas_[face]);
 	    }
 	};
 
-	/// @brief
-	/// @todo Doc me!
+	/// @brief Makes point geometries for DefaultGeometryPolicy.
 	struct GetPointGeom
 	{
-	    /// @brief
-	    /// @todo Doc me!
-	    /// @tparam
-	    /// @param
-	    /// @return 
+	    /// @brief Makes the geometry of the given point.
 	    template <class GridType>
-	    static const EntityVariable<cpgrid::Geometry<0, 3, GridType>, 3>&
-	    value(const DefaultGeometryPolicy<GridType>& geom)
+	    static cpgrid::Geometry<0, 3, GridType>
+	    value(const DefaultGeometryPolicy<GridType>& geom, int point, const int*)
 	    {
-		return geom.point_geom_;
+		return cpgrid::Geometry<0, 3, GridType>(geom.points_[point], 1.0);
 	    }
 	};
 
@@ -85,8 +85,8 @@ namespace Dune
 	    /// Constructor taking a grid and an integer entity representation.
 	    /// This constructor should probably be removed, since it exposes
 	    /// details of the implementation of \see EntityRep, see comment in
-	    /// EntityRep<>::EntityRep(int).
-	    Entity(const GridType& grid, int entityrep)
+	    /// EntityRep<>::EntityRep(IndexType).
+	    Entity(const GridType& grid, IndexType entityrep)
 		: EntityRep<codim>(entityrep), pgrid_(&grid)
 	    {
 	    }
@@ -98,7 +98,7 @@ namespace Dune
 	    }
 
 	    /// Constructor taking a grid, entity index and orientation.
-	    Entity(const GridType& grid, int index, bool orientation)
+	    Entity(const GridType& grid, IndexType index, bool orientation)
 		: EntityRep<codim>(index, orientation), pgrid_(&grid)
 	    {
 	    }
@@ -116,9 +116,11 @@ namespace Dune
 	    }
 
 	    /// Returns the geometry of the entity (does not depend on its orientation).
-	    const Geometry& geometry() const
+	    /// The geometry is made on demand from the grid's geometry arrays,
+	    /// so it is returned by value.
+	    Geometry geometry() const
 	    {
-		return (*pgrid_).template geomVector<codim>()[*this];
+		return (*pgrid_).template entityGeometry<codim>(*this);
 	    }
 
 	    /// We do not support refinement, so level() is always 0.
@@ -308,7 +310,7 @@ namespace Dune
 	    typedef cpgrid::Entity<codim, GridType> Entity;
 
 	    /// Constructor taking a grid and entity representation.
-	    EntityPointer(const GridType& grid, int entityrep)
+	    EntityPointer(const GridType& grid, IndexType entityrep)
 		: Entity(grid, entityrep)
 	    {
 	    }
@@ -326,7 +328,7 @@ namespace Dune
 	    }
 
 	    /// Constructor taking a grid, entity index and orientation.
-	    EntityPointer(const GridType& grid, int index, bool orientation)
+	    EntityPointer(const GridType& grid, IndexType index, bool orientation)
 		: Entity(grid, index, orientation)
 	    {
 	    }
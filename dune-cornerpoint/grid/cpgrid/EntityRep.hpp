@@ -69,7 +69,10 @@ namespace Dune
 #include <dune/common/ErrorMacros.hpp>
 #include <climits>
 //#include <boost/algorithm/minmax_element.hpp>
+#include <boost/cstdint.hpp>
+#include <limits>
 #include <vector>
+#include "../indexwidth.h"
 
 /// The namespace Dune is the main namespace for all Dune code.
 namespace Dune
@@ -77,6 +80,20 @@ namespace Dune
     namespace cpgrid
     {
 
+	/// @brief The integer type used by CpGrid for entity indices and
+	/// for positions in its topology tables.
+	///
+	/// This is int, unless the module is configured with
+	/// --enable-64bit-indices, which is needed for grids with 2^31 or
+	/// more cell faces (counted once per cell). The 32-bit indices
+	/// keep the tables smaller for all other grids. The choice is
+	/// recorded in the installed header indexwidth.h.
+#if CPGRID_64BIT_INDICES
+	typedef boost::int64_t IndexType;
+#else
+	typedef int IndexType;
+#endif
+
 	/// @brief Represents an entity of a given codim, with positive or negative orientation.
 	///
 	/// This class is not a part of the Dune interface, but of our implementation.
@@ -90,11 +107,14 @@ namespace Dune
 	/// We may consider changing this representation to using something like a
 	/// std::pair<int, bool> instead.
 	/// @tparam codim Codimension
+	/// @tparam Index Signed integer type of the representation.
 
-	template <int codim>
+	template <int codim, typename Index = IndexType>
 	class EntityRep
 	{
 	public:
+	    /// The integer type of entity indices.
+	    typedef Index index_type;
 	    /// Default constructor.
 	    EntityRep()
 		: entityrep_(0)
@@ -107,14 +127,14 @@ namespace Dune
 	    /// need to be modified if we change the representation, then we should remove
 	    /// this constructor.
 	    /// @param erep Entity representation.
-	    explicit EntityRep(int erep)
+	    explicit EntityRep(Index erep)
 		: entityrep_(erep)
 	    {
 	    }
 	    /// @brief Constructor taking an entity index and an orientation.
 	    /// @param index Entity index
 	    /// @param orientation True if the entity's orientations is positive.
-	    EntityRep(int index, bool orientation)
+	    EntityRep(Index index, bool orientation)
 		: entityrep_(orientation ? index : ~index)
 	    {
 		ASSERT(index >= 0);
@@ -122,14 +142,14 @@ namespace Dune
 	    /// @brief Set entity value.
 	    /// @param index Entity index
 	    /// @param orientation True if the entity's orientations is positive.
-	    void setValue(int index, bool orientation)
+	    void setValue(Index index, bool orientation)
 	    {
 		ASSERT(index >= 0);
 		entityrep_ = orientation ? index : ~index;
 	    }
 	    /// @brief The (positive) index of an entity. Not a Dune interface method.
 	    /// @return the (positive) index of an entity.
-	    int index() const
+	    Index index() const
 	    {
 		return entityrep_ < 0 ? ~entityrep_ : entityrep_;
 	    }
@@ -157,8 +177,8 @@ namespace Dune
 	    /// @return true if \b this element is less than the \b other.
 	    bool operator<(const EntityRep& other) const
 	    {
-		int i1 = index();
-		int i2 = other.index();
+		Index i1 = index();
+		Index i2 = other.index();
 		if (i1 < i2) return true;
 		if (orientation() && !other.orientation()) return true;
 		return false;
@@ -180,13 +200,17 @@ namespace Dune
 		return !operator==(other);
 	    }
 
-	    enum { InvalidIndex = INT_MAX };
+	    /// An index that no entity has.
+	    static const Index InvalidIndex;
 
 	protected:
 	    // Interior representation is documented in class main comment.
-	    int entityrep_;
+	    Index entityrep_;
 	};
 
+	template <int codim, typename Index>
+	const Index EntityRep<codim, Index>::InvalidIndex = std::numeric_limits<Index>::max();
+
 
 
 	/// @brief Base class for EntityVariable and SignedEntityVariable.
@@ -201,13 +225,21 @@ namespace Dune
 	    using V::empty;
 	    using V::size;
 	    using V::assign;
+	    using V::resize;
+	    using V::begin;
+	    using V::end;
 	    /// Default constructor.
 	    EntityVariableBase()
 	    {
 	    }
+	    /// Exchanges the contents with another variable, without copying.
+	    void swap(EntityVariableBase& other)
+	    {
+		V::swap(other);
+	    }
 
 	protected:
-	    const T& get(int i) const
+	    const T& get(IndexType i) const
 	    {
 		return V::operator[](i);
 	    }
@@ -234,7 +266,8 @@ namespace Dune
 	    /// @brief Random access to the variable through an EntityRep.
 	    /// @param e Entity representation.
 	    /// @return a const reference to the varable, at e.
-	    const T& operator[](const EntityRep<codim>& e) const
+	    template <typename Index>
+	    const T& operator[](const EntityRep<codim, Index>& e) const
 	    {
 		return EntityVariableBase<T>::get(e.index());
 	    }
@@ -262,7 +295,8 @@ namespace Dune
 	    /// @brief Random access to the variable through an EntityRep.
 	    /// Note that this operator always returns a copy, not a
 	    /// reference, since we may need to flip the sign.
-	    const T operator[](const EntityRep<codim>& e) const
+	    template <typename Index>
+	    const T operator[](const EntityRep<codim, Index>& e) const
 	    {
 		return e.orientation() ?
 		    EntityVariableBase<T>::get(e.index()) :
@@ -0,0 +1,65 @@
+//===========================================================================
+//
+// File: HalfFace.hpp
+//
+// Created: Sat Oct 17 16:21:07 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENRS_HALFFACE_HEADER
+#define OPENRS_HALFFACE_HEADER
+
+namespace Dune
+{
+    namespace cpgrid
+    {
+
+	/// @brief One face of a cell, as seen from that cell.
+	///
+	/// The half faces of each cell are stored contiguously, in the
+	/// same order as the cell's row of the cell-to-face table, so
+	/// that solver loops can visit all neighbours of a cell
+	/// without going through the intersection iterators.
+	struct HalfFace
+	{
+	    /// The cell on the other side of the face, or -1 on the boundary.
+	    int neighbour;
+	    /// The face index.
+	    int face;
+	    /// True if the face normal points out of the cell.
+	    bool orientation;
+	    /// True if the face is on the boundary.
+	    bool boundary;
+	};
+
+    } // namespace cpgrid
+} // namespace Dune
+
+
+
+
+#endif // OPENRS_HALFFACE_HEADER
@@ -52,7 +52,7 @@ namespace Dune
 	public:
 	    /// @brief
 	    /// @todo Doc me!
-	    typedef int IndexType;
+	    typedef cpgrid::IndexType IndexType;
 
 	    /// @brief
 	    /// @todo Doc me!
@@ -167,7 +167,7 @@ namespace Dune
 	class IdSet
 	{
 	public:
-	    typedef int IdType;
+	    typedef cpgrid::IndexType IdType;
 
 	    IdSet(const GridType& grid)
 		: grid_(grid)
@@ -209,7 +209,7 @@ namespace Dune
 	    }
 	private:
 	    const GridType& grid_;
-	    int cumul_sizes[4];
+	    IdType cumul_sizes[4];
 	};
 
 
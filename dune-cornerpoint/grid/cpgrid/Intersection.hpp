@@ -52,6 +52,7 @@
 #include "Entity.hpp"
 #include "Geometry.hpp"
 #include "OrientedEntityTable.hpp"
+#include "HalfFace.hpp"
 
 namespace Dune
 {
@@ -91,6 +92,7 @@ namespace Dune
 		  faces_of_cell_(),
 		  global_geom_(),
 // 		  in_inside_geom_(),
+		  has_geom_(false),
 		  nbcell_(-1), // Init to self, which is invalid.
 		  is_on_boundary_(false)
             {
@@ -103,10 +105,12 @@ namespace Dune
 		  index_(cell.index()),
 		  subindex_(subindex),
 		  faces_of_cell_(grid.cell_to_face_[cell]),
-		  global_geom_(cpgrid::Entity<1, GridType>(grid, faces_of_cell_[subindex_]).geometry()),
+		  half_faces_(grid.half_faces_[cell.index()]),
+		  global_geom_(),
 // 		  in_inside_geom_(global_geom_.center()
 // 				  - cpgrid::Entity<0, GridType>(grid, index_).geometry().center(),
 // 				  global_geom_.volume()),
+		  has_geom_(false),
 		  nbcell_(cell.index()), // Init to self, which is invalid.
 		  is_on_boundary_(false)
             {
@@ -272,6 +276,11 @@ namespace Dune
 	    /// @return
             const Geometry& geometry() const
             {
+		// The face geometry is only built when asked for.
+		if (!has_geom_) {
+		    global_geom_ = pgrid_->entityGeometry(faces_of_cell_[subindex_]);
+		    has_geom_ = true;
+		}
 		return global_geom_;
             }
 
@@ -379,9 +388,11 @@ namespace Dune
             int index_;
             int subindex_;
             OrientedEntityTable<0,1>::row_type faces_of_cell_;
-	    Geometry global_geom_;
+	    typename GridType::HalfFaceRange half_faces_;
+	    mutable Geometry global_geom_;
 // 	    LocalGeometry in_inside_geom_;
 // 	    LocalGeometry in_outside_geom_;
+	    mutable bool has_geom_;
 	    int nbcell_;
 	    bool is_on_boundary_;
 
@@ -395,20 +406,13 @@ namespace Dune
 
 	    void update()
 	    {
-                EntityRep<1> face = faces_of_cell_[subindex_];
-		//global_geom_ = cpgrid::Entity<1, GridType>(*pgrid_, face).geometry();
-                global_geom_ = pgrid_->geometry_.template geomVector<1>()[face];
-                OrientedEntityTable<1,0>::row_type cells_of_face = pgrid_->face_to_cell_[face];
-		is_on_boundary_ = (cells_of_face.size() == 1);
+		const HalfFace& hf = half_faces_[subindex_];
+		has_geom_ = false;
+		is_on_boundary_ = hf.boundary;
 		if (is_on_boundary_) {
 		    nbcell_ = index_; // self is invalid value
 		} else {
-                    ASSERT(cells_of_face.size() == 2);
-                    if (cells_of_face[0].index() == index_) {
-                        nbcell_ = cells_of_face[1].index();
-                    } else {
-                        nbcell_ = cells_of_face[0].index();
-                    }
+		    nbcell_ = hf.neighbour;
 // 		    in_outside_geom_ = LocalGeometry(global_geom_.center()
 // 						     - outside().geometry().center(),
 // 						     global_geom_.volume());
@@ -58,7 +58,7 @@ namespace Dune
 	    /// @brief
 	    /// @todo Doc me!
 	    /// @param
-	    Iterator(const GridType& grid, int index)
+	    Iterator(const GridType& grid, IndexType index)
 		: EntityPointer<cd, GridType>(grid, index)
 	    {
 	    }
@@ -52,13 +52,14 @@ namespace Dune
 
 	/// @brief A class used as a row type for  OrientedEntityTable.
 	/// @tparam codim_to Codimension.
-	template <int codim_to>
-	class OrientedEntityRange : private SparseTable< EntityRep<codim_to> >::row_type
+	/// @tparam Index Integer type of entity indices.
+	template <int codim_to, typename Index = IndexType>
+	class OrientedEntityRange : private SparseTable< EntityRep<codim_to, Index>, Index >::row_type
 	{
 	public:
-	    typedef EntityRep<codim_to> ToType;
+	    typedef EntityRep<codim_to, Index> ToType;
 	    typedef ToType* ToTypePtr;
-	    typedef typename SparseTable<ToType>::row_type R;
+	    typedef typename SparseTable<ToType, Index>::row_type R;
 
 	    /// @brief Default constructor yielding an empty range.
 	    OrientedEntityRange()
@@ -97,14 +98,15 @@ namespace Dune
 	/// straight SparseTable would do.
 	/// @tparam codim_from Codimension of ???
 	/// @tparam codim_to Codimension of ???
-	template <int codim_from, int codim_to>
-	class OrientedEntityTable : private SparseTable< EntityRep<codim_to> >
+	/// @tparam Index Integer type of entity indices and table positions.
+	template <int codim_from, int codim_to, typename Index = IndexType>
+	class OrientedEntityTable : private SparseTable< EntityRep<codim_to, Index>, Index >
 	{
 	public:
-	    typedef EntityRep<codim_from> FromType;
-	    typedef EntityRep<codim_to> ToType;
-	    typedef OrientedEntityRange<codim_to> row_type; // ??? doxygen henter doc fra SparseTable
-	    typedef SparseTable<ToType> super_t;
+	    typedef EntityRep<codim_from, Index> FromType;
+	    typedef EntityRep<codim_to, Index> ToType;
+	    typedef OrientedEntityRange<codim_to, Index> row_type; // ??? doxygen henter doc fra SparseTable
+	    typedef SparseTable<ToType, Index> super_t;
 
 	    /// Default constructor.
 	    OrientedEntityTable()
@@ -135,6 +137,13 @@ namespace Dune
 	    using super_t::clear;
 	    using super_t::appendRow;
 
+	    /// @brief Exchanges the contents with another table, without copying.
+	    /// @param other The other table.
+	    void swap(OrientedEntityTable& other)
+	    {
+		super_t::swap(other);
+	    }
+
 	    /// @brief Given an entity e of codimension codim_from,
 	    /// returns the number of neighbours of codimension codim_to.
 	    /// @param e Entity representation.
@@ -176,14 +185,14 @@ namespace Dune
 	    */
 	    void printRelationMatrix(std::ostream& os) const
 	    {
-		int columns = numberOfColumns();
-		for (int i = 0; i < size(); ++i) {
+		Index columns = numberOfColumns();
+		for (Index i = 0; i < size(); ++i) {
 		    FromType from_ent(i);
 		    row_type r  = operator[](from_ent);
-		    int cur_col = 0;
+		    Index cur_col = 0;
 		    int next_ent = 0;
 		    ToType to_ent = r[next_ent];
-		    int next_print = to_ent.index();
+		    Index next_print = to_ent.index();
 		    while (cur_col < columns) {
 			if (cur_col == next_print) {
 			    if (to_ent.orientation()) {
@@ -213,63 +222,63 @@ namespace Dune
 	    /// Implementation note: The algorithm has been changed
 	    /// to a three-pass O(n) algorithm.
 	    /// @param inv  The OrientedEntityTable 
-	    void makeInverseRelation(OrientedEntityTable<codim_to, codim_from>& inv) const
+	    void makeInverseRelation(OrientedEntityTable<codim_to, codim_from, Index>& inv) const
 	    {
 		// Find the maximum index used. This will give (one less than) the size
 		// of the table to be created.
-		int maxind = -1;
-		for (int i = 0; i < size(); ++i) {
-		    EntityRep<codim_from> from_ent(i, true);
+		Index maxind = -1;
+		for (Index i = 0; i < size(); ++i) {
+		    FromType from_ent(i, true);
 		    row_type r = operator[](from_ent);
 		    for (int j = 0; j < r.size(); ++j) {
-			EntityRep<codim_to> to_ent = r[j];
-			int ind = to_ent.index();
+			ToType to_ent = r[j];
+			Index ind = to_ent.index();
 			maxind = std::max(ind, maxind);
 		    }
 		}
 		// Build the new_sizes vector and compute datacount.
-		std::vector<int> new_sizes(maxind + 1);
-		int datacount = 0;
-		for (int i = 0; i < size(); ++i) {
-		    EntityRep<codim_from> from_ent(i, true);
+		std::vector<Index> new_sizes(maxind + 1);
+		Index datacount = 0;
+		for (Index i = 0; i < size(); ++i) {
+		    FromType from_ent(i, true);
 		    row_type r = operator[](from_ent);
 		    datacount += r.size();
 		    for (int j = 0; j < r.size(); ++j) {
-			EntityRep<codim_to> to_ent = r[j];
-			int ind = to_ent.index();
+			ToType to_ent = r[j];
+			Index ind = to_ent.index();
 			++new_sizes[ind];
 		    }
 		}
 		// Compute the cumulative sizes.
-		std::vector<int> cumul_sizes(new_sizes.size() + 1);
+		std::vector<Index> cumul_sizes(new_sizes.size() + 1);
 		cumul_sizes[0] = 0;
 		std::partial_sum(new_sizes.begin(), new_sizes.end(), cumul_sizes.begin() + 1);
 		// Using the cumulative sizes array as indices, we populate new_data.
 		// Note that cumul_sizes[ind] is not kept constant, but incremented so that
 		// it always gives the correct index for new data corresponding to index ind.
-		std::vector<int> new_data(datacount);
-		for (int i = 0; i < size(); ++i) {
-		    EntityRep<codim_from> from_ent(i, true);
+		std::vector<Index> new_data(datacount);
+		for (Index i = 0; i < size(); ++i) {
+		    FromType from_ent(i, true);
 		    row_type r = operator[](from_ent);
 		    for (int j = 0; j < r.size(); ++j) {
-			EntityRep<codim_to> to_ent = r[j];
-			int ind = to_ent.index();
-			int data_ind = cumul_sizes[ind];
+			ToType to_ent = r[j];
+			Index ind = to_ent.index();
+			Index data_ind = cumul_sizes[ind];
 			new_data[data_ind] = to_ent.orientation() ? i : ~i;
 			++cumul_sizes[ind];
 		    }
 		}
-		inv = OrientedEntityTable<codim_to, codim_from>(new_data.begin(),
-								new_data.end(),
-								new_sizes.begin(),
-								new_sizes.end());
+		inv = OrientedEntityTable<codim_to, codim_from, Index>(new_data.begin(),
+								       new_data.end(),
+								       new_sizes.begin(),
+								       new_sizes.end());
 	    }
 
 	private:
-	    int numberOfColumns() const
+	    Index numberOfColumns() const
 	    {
-		int maxind = 0;
-		for (int i = 0; i < size(); ++i) {
+		Index maxind = 0;
+		for (Index i = 0; i < size(); ++i) {
 		    FromType from_ent(i);
 		    row_type r  = operator[](from_ent);
 		    for (int j = 0; j < r.size(); ++j) {
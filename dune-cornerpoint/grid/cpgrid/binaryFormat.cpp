@@ -0,0 +1,471 @@
+//===========================================================================
+//
+// File: binaryFormat.cpp
+//
+// Created: Sat Oct 17 14:02:51 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <dune/common/ErrorMacros.hpp>
+#include "../CpGrid.hpp"
+
+namespace Dune
+{
+
+    // ---- Layout of the binary format ----
+    //
+    // The file starts with a BinaryHeader, followed by these flat
+    // sections, each padded to a multiple of 8 bytes:
+    //
+    //   int    cell_to_face_ row sizes     [num_cells]
+    //   int    cell_to_face_ entries       [num_cell_faces]
+    //   int    face_to_cell_ row sizes     [num_faces]
+    //   int    face_to_cell_ entries       [num_cell_faces]
+    //   int    face_to_point_ row sizes    [num_faces]
+    //   int    face_to_point_ entries      [num_face_points]
+    //   int    cell_to_point_              [8*num_cells]
+    //   int    global_cell_                [num_cells]
+    //   int    face_tag_                   [num_faces]
+    //   double point coordinates           [3*num_points]
+    //   double face_normals_               [3*num_faces]
+    //   double face centroids              [3*num_faces]
+    //   double face areas                  [num_faces]
+    //   double cell centroids              [3*num_cells]
+    //   double cell volumes                [num_cells]
+    //
+    // Oriented entities are stored as in EntityRep, i.e. as index
+    // or ~index for positive and negative orientation.  The data
+    // are in native byte order; byte_order lets a reader detect a
+    // file written on a machine with the opposite byte order.
+    // Files written to the grid cache carry the cache key of their
+    // input in the header, which is checked when the file is reused.
+    // Increase binary_version whenever the layout changes.
+
+    namespace
+    {
+	const char binary_magic[8] = { 'C', 'P', 'G', 'R', 'I', 'D', 'B', 'N' };
+	const int binary_version = 2;
+	const int binary_byte_order = 0x01020304;
+
+	struct BinaryHeader
+	{
+	    char magic[8];
+	    int version;
+	    int byte_order;
+	    int logical_cartesian_size[3];
+	    int cart_dims[3];
+	    int num_cells;
+	    int num_faces;
+	    int num_points;
+	    int num_cell_faces;
+	    int num_face_points;
+	    int padding;
+	    // Key of the grid cache entry, zero if not written to the cache.
+	    boost::uint64_t cache_key[2];
+	};
+
+	size_t paddedSize(size_t bytes)
+	{
+	    return (bytes + 7) & ~7;
+	}
+
+	template <typename T>
+	void writeSection(std::ostream& os, const std::vector<T>& data)
+	{
+	    const size_t bytes = data.size()*sizeof(T);
+	    if (bytes > 0) {
+		os.write(reinterpret_cast<const char*>(&data[0]), bytes);
+	    }
+	    const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	    os.write(zeros, paddedSize(bytes) - bytes);
+	}
+
+	template <int codim_from, int codim_to>
+	void flattenTable(const cpgrid::OrientedEntityTable<codim_from, codim_to>& table,
+			  std::vector<int>& row_sizes,
+			  std::vector<int>& entries)
+	{
+	    const int num_rows = table.size();
+	    row_sizes.resize(num_rows);
+	    entries.clear();
+	    entries.reserve(table.dataSize());
+	    for (int i = 0; i < num_rows; ++i) {
+		cpgrid::EntityRep<codim_from> from(i, true);
+		typename cpgrid::OrientedEntityTable<codim_from, codim_to>::row_type row = table[from];
+		const int row_size = row.size();
+		row_sizes[i] = row_size;
+		for (int j = 0; j < row_size; ++j) {
+		    entries.push_back(row[j].orientation() ? row[j].index() : ~row[j].index());
+		}
+	    }
+	}
+
+	/// A read-only memory mapping of an entire file.
+	class MappedFile
+	{
+	public:
+	    explicit MappedFile(const std::string& filename)
+		: data_(0), size_(0)
+	    {
+		int fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) {
+		    THROW("Could not open file " << filename);
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(BinaryHeader))) {
+		    close(fd);
+		    THROW("File " << filename << " is too short to be a binary grid.");
+		}
+		size_ = st.st_size;
+		void* addr = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (addr == MAP_FAILED) {
+		    THROW("Could not map file " << filename);
+		}
+		data_ = static_cast<const char*>(addr);
+	    }
+	    ~MappedFile()
+	    {
+		munmap(const_cast<char*>(data_), size_);
+	    }
+	    const char* data() const
+	    {
+		return data_;
+	    }
+	    size_t size() const
+	    {
+		return size_;
+	    }
+	private:
+	    MappedFile(const MappedFile&);
+	    MappedFile& operator=(const MappedFile&);
+	    const char* data_;
+	    size_t size_;
+	};
+
+	/// Returns the section of count elements starting at pos,
+	/// and advances pos past it (and its padding).
+	template <typename T>
+	const T* nextSection(const char*& pos, const char* end, int count)
+	{
+	    if (count < 0) {
+		THROW("Binary grid file has a negative section size.");
+	    }
+	    const size_t bytes = size_t(count)*sizeof(T);
+	    if (size_t(end - pos) < paddedSize(bytes)) {
+		THROW("Binary grid file is truncated.");
+	    }
+	    const T* section = reinterpret_cast<const T*>(pos);
+	    pos += paddedSize(bytes);
+	    return section;
+	}
+
+	/// Checks that the num_rows row sizes are nonnegative and add
+	/// up to num_entries, the size of the table's entry section.
+	void checkRowSizes(const int* sizes, int num_rows, int num_entries, const char* table)
+	{
+	    size_t sum = 0;
+	    for (int i = 0; i < num_rows; ++i) {
+		if (sizes[i] < 0) {
+		    THROW("Binary grid file has a negative row size in " << table << '.');
+		}
+		sum += sizes[i];
+	    }
+	    if (sum != size_t(num_entries)) {
+		THROW("Binary grid file has row sizes in " << table << " adding up to "
+		      << sum << ", expected " << num_entries << '.');
+	    }
+	}
+
+	/// Checks that the count entries are indices in [0, bound). If
+	/// oriented, negative entries are stored as ~index.
+	void checkIndices(const int* entries, int count, int bound, bool oriented, const char* table)
+	{
+	    for (int i = 0; i < count; ++i) {
+		const int index = (oriented && entries[i] < 0) ? ~entries[i] : entries[i];
+		if (index < 0 || index >= bound) {
+		    THROW("Binary grid file has index " << index << " out of range [0, "
+			  << bound << ") in " << table << '.');
+		}
+	    }
+	}
+
+    } // anon namespace
+
+
+
+
+    void CpGrid::writeBinary(const std::string& filename) const
+    {
+	writeBinaryFile(filename, 0);
+    }
+
+
+
+
+    void CpGrid::writeBinaryFile(const std::string& filename, const boost::uint64_t* cache_key) const
+    {
+	const int num_cells = cell_to_face_.size();
+	const int num_faces = face_to_cell_.size();
+	const std::vector<PointType>& points = geometry_.points();
+	const int num_points = points.size();
+	if (cell_to_face_.dataSize() > INT_MAX || face_to_point_.dataSize() > INT_MAX) {
+	    THROW("Grid is too large for the binary grid format, which uses 32-bit indices.");
+	}
+
+	BinaryHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+	header.version = binary_version;
+	header.byte_order = binary_byte_order;
+	for (int dd = 0; dd < 3; ++dd) {
+	    header.logical_cartesian_size[dd] = logical_cartesian_size_[dd];
+	    header.cart_dims[dd] = cartDims_[dd];
+	}
+	header.num_cells = num_cells;
+	header.num_faces = num_faces;
+	header.num_points = num_points;
+	header.num_cell_faces = cell_to_face_.dataSize();
+	header.num_face_points = face_to_point_.dataSize();
+	if (cache_key != 0) {
+	    header.cache_key[0] = cache_key[0];
+	    header.cache_key[1] = cache_key[1];
+	}
+
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+	if (!file) {
+	    THROW("Could not open file " << filename);
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// Topology.
+	std::vector<int> row_sizes;
+	std::vector<int> entries;
+	flattenTable(cell_to_face_, row_sizes, entries);
+	writeSection(file, row_sizes);
+	writeSection(file, entries);
+	flattenTable(face_to_cell_, row_sizes, entries);
+	writeSection(file, row_sizes);
+	writeSection(file, entries);
+	row_sizes.resize(num_faces);
+	entries.clear();
+	for (int face = 0; face < num_faces; ++face) {
+	    SparseTable<int, cpgrid::IndexType>::row_type fp = face_to_point_[face];
+	    row_sizes[face] = fp.size();
+	    entries.insert(entries.end(), fp.begin(), fp.end());
+	}
+	writeSection(file, row_sizes);
+	writeSection(file, entries);
+	entries.resize(8*num_cells);
+	for (int cell = 0; cell < num_cells; ++cell) {
+	    std::copy(cell_to_point_[cell].begin(), cell_to_point_[cell].end(), entries.begin() + 8*cell);
+	}
+	writeSection(file, entries);
+	writeSection(file, global_cell_);
+	entries.assign(face_tag_.begin(), face_tag_.end());
+	writeSection(file, entries);
+
+	// Geometry.
+	std::vector<double> values(3*num_points);
+	for (int i = 0; i < num_points; ++i) {
+	    std::copy(points[i].begin(), points[i].end(), values.begin() + 3*i);
+	}
+	writeSection(file, values);
+	values.resize(3*num_faces);
+	for (int face = 0; face < num_faces; ++face) {
+	    PointType normal = face_normals_[cpgrid::EntityRep<1>(face, true)];
+	    std::copy(normal.begin(), normal.end(), values.begin() + 3*face);
+	}
+	writeSection(file, values);
+	for (int face = 0; face < num_faces; ++face) {
+	    for (int dd = 0; dd < 3; ++dd) {
+		values[3*face + dd] = geometry_.faceCentroids(dd)[face];
+	    }
+	}
+	writeSection(file, values);
+	writeSection(file, geometry_.faceAreas());
+	values.resize(3*num_cells);
+	for (int cell = 0; cell < num_cells; ++cell) {
+	    for (int dd = 0; dd < 3; ++dd) {
+		values[3*cell + dd] = geometry_.cellCentroids(dd)[cell];
+	    }
+	}
+	writeSection(file, values);
+	writeSection(file, geometry_.cellVolumes());
+
+	if (!file) {
+	    THROW("Error writing binary grid file " << filename);
+	}
+    }
+
+
+
+
+    void CpGrid::readBinary(const std::string& filename)
+    {
+	readBinaryFile(filename, 0);
+    }
+
+
+
+
+    void CpGrid::readBinaryFile(const std::string& filename, const boost::uint64_t* cache_key)
+    {
+	MappedFile file(filename);
+	const char* pos = file.data();
+	const char* end = file.data() + file.size();
+
+	BinaryHeader header;
+	std::memcpy(&header, pos, sizeof(header));
+	pos += sizeof(header);
+	if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0) {
+	    THROW("File " << filename << " is not a binary grid file.");
+	}
+	if (header.byte_order != binary_byte_order) {
+	    THROW("Binary grid file " << filename << " was written with a different byte order.");
+	}
+	if (header.version != binary_version) {
+	    THROW("Binary grid file " << filename << " has version " << header.version
+		  << ", expected version " << binary_version);
+	}
+	if (cache_key != 0
+	    && (header.cache_key[0] != cache_key[0] || header.cache_key[1] != cache_key[1])) {
+	    THROW("Binary grid file " << filename << " does not match the grid cache key.");
+	}
+	const int num_cells = header.num_cells;
+	const int num_faces = header.num_faces;
+	const int num_points = header.num_points;
+	if (num_cells > INT_MAX/8 || num_faces > INT_MAX/3 || num_points > INT_MAX/3) {
+	    THROW("Binary grid file " << filename << " has too many entities.");
+	}
+
+	const int* c2f_sizes   = nextSection<int>(pos, end, num_cells);
+	const int* c2f_entries = nextSection<int>(pos, end, header.num_cell_faces);
+	const int* f2c_sizes   = nextSection<int>(pos, end, num_faces);
+	const int* f2c_entries = nextSection<int>(pos, end, header.num_cell_faces);
+	const int* f2p_sizes   = nextSection<int>(pos, end, num_faces);
+	const int* f2p_entries = nextSection<int>(pos, end, header.num_face_points);
+	const int* c2p         = nextSection<int>(pos, end, 8*num_cells);
+	const int* gcell       = nextSection<int>(pos, end, num_cells);
+	const int* tags        = nextSection<int>(pos, end, num_faces);
+	const double* points          = nextSection<double>(pos, end, 3*num_points);
+	const double* normals         = nextSection<double>(pos, end, 3*num_faces);
+	const double* face_centroids  = nextSection<double>(pos, end, 3*num_faces);
+	const double* face_areas      = nextSection<double>(pos, end, num_faces);
+	const double* cell_centroids  = nextSection<double>(pos, end, 3*num_cells);
+	const double* cell_volumes    = nextSection<double>(pos, end, num_cells);
+	if (pos != end) {
+	    THROW("Binary grid file " << filename << " has trailing data.");
+	}
+
+	// Check the topology before building tables from it, so that
+	// a corrupt file cannot cause out of range indexing.
+	checkRowSizes(c2f_sizes, num_cells, header.num_cell_faces, "cell_to_face");
+	checkRowSizes(f2c_sizes, num_faces, header.num_cell_faces, "face_to_cell");
+	checkRowSizes(f2p_sizes, num_faces, header.num_face_points, "face_to_point");
+	checkIndices(c2f_entries, header.num_cell_faces, num_faces, true, "cell_to_face");
+	checkIndices(f2c_entries, header.num_cell_faces, num_cells, true, "face_to_cell");
+	checkIndices(f2p_entries, header.num_face_points, num_points, false, "face_to_point");
+	checkIndices(c2p, 8*num_cells, num_points, false, "cell_to_point");
+	checkIndices(tags, num_faces, TOP + 1, false, "face_tag");
+	size_t num_global_cells = 1;
+	for (int dd = 0; dd < 3; ++dd) {
+	    if (header.logical_cartesian_size[dd] < 0) {
+		THROW("Binary grid file " << filename << " has a negative logical cartesian size.");
+	    }
+	    num_global_cells *= header.logical_cartesian_size[dd];
+	}
+	checkIndices(gcell, num_cells, int(std::min(num_global_cells, size_t(INT_MAX))), false, "global_cell");
+
+	// Topology.
+	cpgrid::OrientedEntityTable<0, 1> c2f(c2f_entries, c2f_entries + header.num_cell_faces,
+					      c2f_sizes, c2f_sizes + num_cells);
+	cell_to_face_.swap(c2f);
+	cpgrid::OrientedEntityTable<1, 0> f2c(f2c_entries, f2c_entries + header.num_cell_faces,
+					      f2c_sizes, f2c_sizes + num_faces);
+	face_to_cell_.swap(f2c);
+	SparseTable<int, cpgrid::IndexType> f2p(f2p_entries, f2p_entries + header.num_face_points,
+			     f2p_sizes, f2p_sizes + num_faces);
+	face_to_point_.swap(f2p);
+	cell_to_point_.resize(num_cells);
+	for (int cell = 0; cell < num_cells; ++cell) {
+	    std::copy(c2p + 8*cell, c2p + 8*(cell + 1), cell_to_point_[cell].begin());
+	}
+	global_cell_.assign(gcell, gcell + num_cells);
+	face_tag_.resize(num_faces);
+	for (int face = 0; face < num_faces; ++face) {
+	    face_tag_.begin()[face] = static_cast<enum face_tag>(tags[face]);
+	}
+	for (int dd = 0; dd < 3; ++dd) {
+	    logical_cartesian_size_[dd] = header.logical_cartesian_size[dd];
+	    cartDims_[dd] = header.cart_dims[dd];
+	}
+
+	// Geometry.
+	Geom geom;
+	geom.resize(num_cells, num_faces, num_points);
+	std::vector<PointType>& geom_points = geom.points();
+	for (int i = 0; i < num_points; ++i) {
+	    std::copy(points + 3*i, points + 3*(i + 1), geom_points[i].begin());
+	}
+	face_normals_.resize(num_faces);
+	for (int face = 0; face < num_faces; ++face) {
+	    PointType centroid;
+	    std::copy(face_centroids + 3*face, face_centroids + 3*(face + 1), centroid.begin());
+	    geom.setFace(face, centroid, face_areas[face]);
+	    std::copy(normals + 3*face, normals + 3*(face + 1), face_normals_.begin()[face].begin());
+	}
+	for (int cell = 0; cell < num_cells; ++cell) {
+	    PointType centroid;
+	    std::copy(cell_centroids + 3*cell, cell_centroids + 3*(cell + 1), centroid.begin());
+	    geom.setCell(cell, centroid, cell_volumes[cell]);
+	}
+	geometry_.swap(geom);
+
+	computeUniqueBoundaryIds();
+	computeHalfFaces();
+    }
+
+
+
+} // namespace Dune
@@ -0,0 +1,354 @@
+//===========================================================================
+//
+// File: cellOrdering.cpp
+//
+// Created: Sat Oct 17 17:05:44 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <boost/cstdint.hpp>
+#include "../CpGrid.hpp"
+
+namespace Dune
+{
+
+
+    namespace
+    {
+
+	/// Orders a and b by degree, then by index.
+	struct DegreeLess
+	{
+	    explicit DegreeLess(const std::vector<int>& degree) : degree_(degree) {}
+	    bool operator()(int a, int b) const
+	    {
+		return degree_[a] < degree_[b] || (degree_[a] == degree_[b] && a < b);
+	    }
+	    const std::vector<int>& degree_;
+	};
+
+	/// Reverse Cuthill-McKee ordering of the graph with adjacency
+	/// lists nb[nb_start[c], nb_start[c+1]). Each connected
+	/// component is started from one of its cells of minimum degree.
+	/// On return, order[i] is the old number of new cell i.
+	void rcmOrder(const std::vector<int>& nb_start,
+		      const std::vector<int>& nb,
+		      std::vector<int>& order)
+	{
+	    const int num_cells = nb_start.size() - 1;
+	    std::vector<int> degree(num_cells);
+	    for (int c = 0; c < num_cells; ++c) {
+		degree[c] = nb_start[c + 1] - nb_start[c];
+	    }
+	    std::vector<int> by_degree(num_cells);
+	    for (int c = 0; c < num_cells; ++c) {
+		by_degree[c] = c;
+	    }
+	    DegreeLess less(degree);
+	    std::sort(by_degree.begin(), by_degree.end(), less);
+
+	    std::vector<bool> visited(num_cells, false);
+	    order.clear();
+	    order.reserve(num_cells);
+	    std::vector<int> next;
+	    for (int s = 0; s < num_cells; ++s) {
+		const int start = by_degree[s];
+		if (visited[start]) {
+		    continue;
+		}
+		// Breadth first search, using order as the queue.
+		visited[start] = true;
+		order.push_back(start);
+		for (int head = order.size() - 1; head < int(order.size()); ++head) {
+		    const int c = order[head];
+		    next.clear();
+		    for (int i = nb_start[c]; i < nb_start[c + 1]; ++i) {
+			if (!visited[nb[i]]) {
+			    visited[nb[i]] = true;
+			    next.push_back(nb[i]);
+			}
+		    }
+		    std::sort(next.begin(), next.end(), less);
+		    order.insert(order.end(), next.begin(), next.end());
+		}
+	    }
+	    std::reverse(order.begin(), order.end());
+	}
+
+	/// Returns the index along a 3D Hilbert curve of the point with
+	/// integer coordinates x, each in [0, 2^bits). Uses Skilling's
+	/// transpose algorithm (AIP Conf. Proc. 707, 2004).
+	boost::uint64_t hilbertIndex(unsigned int x[3], int bits)
+	{
+	    const unsigned int m = 1u << (bits - 1);
+	    // Inverse undo excess work.
+	    for (unsigned int q = m; q > 1; q >>= 1) {
+		const unsigned int p = q - 1;
+		for (int i = 0; i < 3; ++i) {
+		    if (x[i] & q) {
+			x[0] ^= p;
+		    } else {
+			const unsigned int t = (x[0] ^ x[i]) & p;
+			x[0] ^= t;
+			x[i] ^= t;
+		    }
+		}
+	    }
+	    // Gray encode.
+	    x[1] ^= x[0];
+	    x[2] ^= x[1];
+	    unsigned int t = 0;
+	    for (unsigned int q = m; q > 1; q >>= 1) {
+		if (x[2] & q) {
+		    t ^= q - 1;
+		}
+	    }
+	    for (int i = 0; i < 3; ++i) {
+		x[i] ^= t;
+	    }
+	    // Interleave the transposed bits.
+	    boost::uint64_t h = 0;
+	    for (int b = bits - 1; b >= 0; --b) {
+		for (int i = 0; i < 3; ++i) {
+		    h = (h << 1) | ((x[i] >> b) & 1u);
+		}
+	    }
+	    return h;
+	}
+
+	/// Orders cells along a Hilbert curve through their centroids.
+	/// On return, order[i] is the old number of new cell i.
+	void hilbertOrder(const std::vector<FieldVector<double, 3> >& centroids,
+			  std::vector<int>& order)
+	{
+	    const int bits = 16;
+	    const int num_cells = centroids.size();
+	    FieldVector<double, 3> lo(1e100);
+	    FieldVector<double, 3> hi(-1e100);
+	    for (int c = 0; c < num_cells; ++c) {
+		for (int dd = 0; dd < 3; ++dd) {
+		    lo[dd] = std::min(lo[dd], centroids[c][dd]);
+		    hi[dd] = std::max(hi[dd], centroids[c][dd]);
+		}
+	    }
+	    const double cells_per_axis = double((1u << bits) - 1);
+	    std::vector<std::pair<boost::uint64_t, int> > keys(num_cells);
+	    for (int c = 0; c < num_cells; ++c) {
+		unsigned int x[3];
+		for (int dd = 0; dd < 3; ++dd) {
+		    const double len = hi[dd] - lo[dd];
+		    x[dd] = len > 0.0 ? (unsigned int)((centroids[c][dd] - lo[dd])/len*cells_per_axis) : 0u;
+		}
+		keys[c] = std::make_pair(hilbertIndex(x, bits), c);
+	    }
+	    std::sort(keys.begin(), keys.end());
+	    order.resize(num_cells);
+	    for (int c = 0; c < num_cells; ++c) {
+		order[c] = keys[c].second;
+	    }
+	}
+
+	/// Appends the entries of [beg, end) not yet numbered to
+	/// old_of_new, numbering them in order of appearance.
+	template <class Iter>
+	void numberByAppearance(Iter beg, Iter end,
+				std::vector<int>& new_of_old,
+				std::vector<int>& old_of_new)
+	{
+	    for (; beg != end; ++beg) {
+		const int old_index = *beg;
+		if (new_of_old[old_index] == -1) {
+		    new_of_old[old_index] = old_of_new.size();
+		    old_of_new.push_back(old_index);
+		}
+	    }
+	}
+
+    } // anon namespace
+
+
+
+
+    /// Renumber cells in the chosen ordering. Faces and points are
+    /// then numbered in order of first appearance, so that the faces
+    /// and corners of consecutive cells are also close in memory.
+    /// Must be called before the derived boundary ids and half faces
+    /// are computed.
+    void CpGrid::applyCellOrdering()
+    {
+	if (cell_ordering_ == CartesianOrdering) {
+	    return;
+	}
+	const int num_cells = cell_to_face_.size();
+	const int num_faces = face_to_cell_.size();
+	const int num_points = geometry_.size<3>();
+
+	// Find the new cell order.
+	std::vector<int> cell_old_of_new;
+	if (cell_ordering_ == ReverseCuthillMcKeeOrdering) {
+	    std::vector<int> nb_start(1, 0);
+	    std::vector<int> nb;
+	    nb_start.reserve(num_cells + 1);
+	    for (int c = 0; c < num_cells; ++c) {
+		cpgrid::OrientedEntityTable<0, 1>::row_type faces = cell_to_face_[cpgrid::EntityRep<0>(c, true)];
+		const int row_begin = nb.size();
+		for (int i = 0; i < faces.size(); ++i) {
+		    cpgrid::OrientedEntityTable<1, 0>::row_type cells = face_to_cell_[faces[i]];
+		    for (int j = 0; j < cells.size(); ++j) {
+			if (cells[j].index() != c) {
+			    nb.push_back(cells[j].index());
+			}
+		    }
+		}
+		// Faulted cells may share several faces.
+		std::sort(nb.begin() + row_begin, nb.end());
+		nb.erase(std::unique(nb.begin() + row_begin, nb.end()), nb.end());
+		nb_start.push_back(nb.size());
+	    }
+	    rcmOrder(nb_start, nb, cell_old_of_new);
+	} else if (cell_ordering_ == HilbertOrdering) {
+	    std::vector<FieldVector<double, 3> > centroids(num_cells);
+	    for (int c = 0; c < num_cells; ++c) {
+		centroids[c] = geometry_.cellCentroid(c);
+	    }
+	    hilbertOrder(centroids, cell_old_of_new);
+	} else {
+	    THROW("Unknown cell ordering " << cell_ordering_);
+	}
+	std::vector<int> cell_new_of_old(num_cells);
+	for (int c = 0; c < num_cells; ++c) {
+	    cell_new_of_old[cell_old_of_new[c]] = c;
+	}
+
+	// Number faces as they appear in the new cells, and points as
+	// they appear in the new faces and cells.
+	std::vector<int> face_new_of_old(num_faces, -1);
+	std::vector<int> face_old_of_new;
+	face_old_of_new.reserve(num_faces);
+	for (int c = 0; c < num_cells; ++c) {
+	    cpgrid::OrientedEntityTable<0, 1>::row_type faces
+		= cell_to_face_[cpgrid::EntityRep<0>(cell_old_of_new[c], true)];
+	    for (int i = 0; i < faces.size(); ++i) {
+		const int f = faces[i].index();
+		numberByAppearance(&f, &f + 1, face_new_of_old, face_old_of_new);
+	    }
+	}
+	ASSERT(int(face_old_of_new.size()) == num_faces);
+	std::vector<int> point_new_of_old(num_points, -1);
+	std::vector<int> point_old_of_new;
+	point_old_of_new.reserve(num_points);
+	for (int f = 0; f < num_faces; ++f) {
+	    SparseTable<int, cpgrid::IndexType>::row_type pts = face_to_point_[face_old_of_new[f]];
+	    numberByAppearance(pts.begin(), pts.end(), point_new_of_old, point_old_of_new);
+	}
+	for (int c = 0; c < num_cells; ++c) {
+	    const array<int, 8>& corners = cell_to_point_[cell_old_of_new[c]];
+	    numberByAppearance(corners.begin(), corners.end(), point_new_of_old, point_old_of_new);
+	}
+	for (int p = 0; p < num_points; ++p) {
+	    numberByAppearance(&p, &p + 1, point_new_of_old, point_old_of_new);
+	}
+
+	// Topology.
+	std::vector<cpgrid::EntityRep<1> > c2f_data;
+	std::vector<int> c2f_sizes(num_cells);
+	c2f_data.reserve(cell_to_face_.dataSize());
+	std::vector<array<int, 8> > c2p(num_cells);
+	std::vector<int> gc(num_cells);
+	for (int c = 0; c < num_cells; ++c) {
+	    const int old_c = cell_old_of_new[c];
+	    cpgrid::OrientedEntityTable<0, 1>::row_type faces = cell_to_face_[cpgrid::EntityRep<0>(old_c, true)];
+	    c2f_sizes[c] = faces.size();
+	    for (int i = 0; i < faces.size(); ++i) {
+		c2f_data.push_back(cpgrid::EntityRep<1>(face_new_of_old[faces[i].index()], faces[i].orientation()));
+	    }
+	    for (int k = 0; k < 8; ++k) {
+		c2p[c][k] = point_new_of_old[cell_to_point_[old_c][k]];
+	    }
+	    gc[c] = global_cell_[old_c];
+	}
+	std::vector<cpgrid::EntityRep<0> > f2c_data;
+	std::vector<int> f2c_sizes(num_faces);
+	f2c_data.reserve(face_to_cell_.dataSize());
+	std::vector<int> f2p_data;
+	std::vector<int> f2p_sizes(num_faces);
+	f2p_data.reserve(face_to_point_.dataSize());
+	std::vector<enum face_tag> tags(num_faces);
+	std::vector<PointType> normals(num_faces);
+	for (int f = 0; f < num_faces; ++f) {
+	    const int old_f = face_old_of_new[f];
+	    // Keep the order of the two cells of a face, which defines
+	    // the direction of its normal.
+	    cpgrid::OrientedEntityTable<1, 0>::row_type cells = face_to_cell_[cpgrid::EntityRep<1>(old_f, true)];
+	    f2c_sizes[f] = cells.size();
+	    for (int j = 0; j < cells.size(); ++j) {
+		f2c_data.push_back(cpgrid::EntityRep<0>(cell_new_of_old[cells[j].index()], cells[j].orientation()));
+	    }
+	    SparseTable<int, cpgrid::IndexType>::row_type pts = face_to_point_[old_f];
+	    f2p_sizes[f] = pts.size();
+	    for (const int* p = pts.begin(); p != pts.end(); ++p) {
+		f2p_data.push_back(point_new_of_old[*p]);
+	    }
+	    tags[f] = face_tag_.begin()[old_f];
+	    normals[f] = face_normals_.begin()[old_f];
+	}
+	cell_to_face_ = cpgrid::OrientedEntityTable<0, 1>(c2f_data.begin(), c2f_data.end(),
+							  c2f_sizes.begin(), c2f_sizes.end());
+	face_to_cell_ = cpgrid::OrientedEntityTable<1, 0>(f2c_data.begin(), f2c_data.end(),
+							  f2c_sizes.begin(), f2c_sizes.end());
+	face_to_point_.assign(f2p_data.begin(), f2p_data.end(), f2p_sizes.begin(), f2p_sizes.end());
+	cell_to_point_.swap(c2p);
+	global_cell_.swap(gc);
+	face_tag_.assign(tags.begin(), tags.end());
+	face_normals_.assign(normals.begin(), normals.end());
+
+	// Geometry.
+	Geom geom;
+	geom.resize(num_cells, num_faces, num_points);
+	for (int c = 0; c < num_cells; ++c) {
+	    const int old_c = cell_old_of_new[c];
+	    geom.setCell(c, geometry_.cellCentroid(old_c), geometry_.cellVolumes()[old_c]);
+	}
+	for (int f = 0; f < num_faces; ++f) {
+	    const int old_f = face_old_of_new[f];
+	    geom.setFace(f, geometry_.faceCentroid(old_f), geometry_.faceAreas()[old_f]);
+	}
+	for (int p = 0; p < num_points; ++p) {
+	    geom.points()[p] = geometry_.points()[point_old_of_new[p]];
+	}
+	geometry_.swap(geom);
+    }
+
+
+
+} // namespace Dune
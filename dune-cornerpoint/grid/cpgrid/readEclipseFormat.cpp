@@ -38,6 +38,12 @@
 #include "config.h"
 #endif
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <boost/cstdint.hpp>
 #include "../CpGrid.hpp"
 #include <dune/common/EclipseGridParser.hpp>
 #include <dune/common/EclipseGridInspector.hpp>
@@ -54,26 +60,50 @@ namespace Dune
     // Forward declarations.
     namespace
     {
-	void addOuterCellLayer(const grdecl& original,
-			       std::vector<double>& new_coord,
-			       std::vector<double>& new_zcorn,
-			       std::vector<int>& new_actnum,
-			       grdecl& output);
+	std::string gridCacheFile(const std::string& cache_dir,
+				  const grdecl& g,
+				  int num_coord,
+				  int num_zcorn,
+				  bool has_actnum,
+				  double z_tolerance,
+				  bool periodic_extension,
+				  bool turn_normals,
+				  bool clip_z,
+				  int cell_ordering,
+				  boost::uint64_t* cache_key);
+	/// Source of the corner-point data of a grid extended
+	/// periodically with one layer of cells in the (i, j)
+	/// directions, for process_grdecl_stream(). The data of the
+	/// extended grid are computed from the original grid as they
+	/// are read, so only the (small) COORD of the extended grid is
+	/// stored.
+	struct PeriodicSource
+	{
+	    const grdecl* original;
+	    double clip_bot; // Clipping interval of the original z values.
+	    double clip_top;
+	    double zb;       // The extended grid is clamped to [zb, zt],
+	    double zt;       // making it a shoe box.
+	};
+	void makePeriodicSource(const grdecl& original,
+				double clip_bot,
+				double clip_top,
+				std::vector<double>& new_coord,
+				PeriodicSource& ctx,
+				grdecl_source& src);
 	void removeOuterCellLayer(processed_grid& grid);
 	void buildTopo(const processed_grid& output,
 		       std::vector<int>& global_cell,
 		       cpgrid::OrientedEntityTable<0, 1>& c2f,
 		       cpgrid::OrientedEntityTable<1, 0>& f2c,
-		       SparseTable<int>& f2p,
+		       SparseTable<int, cpgrid::IndexType>& f2p,
 		       std::vector<array<int,8> >& c2p,
 		       std::vector<int>& face_to_output_face);
 	void buildGeom(const processed_grid& output,
 		       const cpgrid::OrientedEntityTable<0, 1>& c2f,
-		       const std::vector<array<int,8> >& c2p,
 		       const std::vector<int>& face_to_output_face,
 		       cpgrid::DefaultGeometryPolicy<CpGrid>& gpol,
 		       cpgrid::SignedEntityVariable<FieldVector<double, 3> , 1>& normals,
-		       std::vector<FieldVector<double, 3> >& allcorners,
                        bool turn_normals);
     } // anon namespace
 
@@ -88,7 +118,8 @@ namespace Dune
 #ifdef VERBOSE
 	std::cout << "Parsing " << filename << std::endl;
 #endif
-	EclipseGridParser parser(filename);
+	// Only the grid fields are needed, so read lazily.
+	EclipseGridParser parser(filename, EclipseGridParser::LazyFields);
 	processEclipseFormat(parser, z_tolerance, periodic_extension, turn_normals);
     }
 
@@ -123,8 +154,32 @@ namespace Dune
 	    g.actnum = &default_actnum[0]; // default_actnum dies at the end of this function
 	}
 
-        // Handle zcorn clipping.
-        std::vector<double> clipped_zcorn;
+	// Look for an already processed grid in the cache, if enabled.
+	std::string cache_file;
+	boost::uint64_t cache_key[2] = { 0, 0 };
+	if (!grid_cache_dir_.empty()) {
+	    cache_file = gridCacheFile(grid_cache_dir_, g,
+				       parser.getFloatingPointValue("COORD").size(),
+				       parser.getFloatingPointValue("ZCORN").size(),
+				       parser.hasField("ACTNUM"),
+				       z_tolerance, periodic_extension, turn_normals, clip_z,
+				       cell_ordering_, cache_key);
+	    if (access(cache_file.c_str(), R_OK) == 0) {
+		try {
+		    readBinaryFile(cache_file, cache_key);
+#ifdef VERBOSE
+		    std::cout << "Read processed grid from cache " << cache_file << std::endl;
+#endif
+		    return;
+		} catch (const std::exception&) {
+		}
+		MESSAGE("Ignoring unusable grid cache file " << cache_file);
+	    }
+	}
+
+        // Find the z interval to clip to, if clipping.
+        double clip_bot = -1e100;
+        double clip_top = 1e100;
         if (clip_z) {
             double minz_top = 1e100;
             double maxz_bot = -1e100;
@@ -141,27 +196,62 @@ namespace Dune
             if (minz_top <= maxz_bot) {
                 THROW("Grid cannot be clipped to a shoe-box (in z): Would be empty afterwards.");
             }
-            int num_zcorn = parser.getFloatingPointValue("ZCORN").size();
-            clipped_zcorn.resize(num_zcorn);
-            for (int i = 0; i < num_zcorn; ++i) {
-                clipped_zcorn[i] = std::max(maxz_bot, std::min(minz_top, g.zcorn[i]));
-            }
-            g.zcorn = &clipped_zcorn[0];
+            clip_bot = maxz_bot;
+            clip_top = minz_top;
         }
 
 	if (periodic_extension) {
 	    // Extend grid periodically with one layer of cells in the (i, j) directions.
+	    // The extended (and clipped) data are computed while processing a few
+	    // rows at a time, instead of building copies of the whole grid.
 	    std::vector<double> new_coord;
-	    std::vector<double> new_zcorn;
-	    std::vector<int> new_actnum;
-	    grdecl new_g;	    
-	    addOuterCellLayer(g, new_coord, new_zcorn, new_actnum, new_g);
+	    PeriodicSource ctx;
+	    grdecl_source src;
+	    makePeriodicSource(g, clip_bot, clip_top, new_coord, ctx, src);
+	    processed_grid output;
+	    FILE* fp = std::tmpfile();
+	    if (fp == 0) {
+		THROW("Could not create temporary file for grid processing.");
+	    }
+	    const int slab_rows = std::max(1, src.dims[1]/8);
+	    bool ok = process_grdecl_stream(&src, z_tolerance, slab_rows, fp);
+	    ok = ok && std::fseek(fp, 0, SEEK_SET) == 0;
+	    ok = ok && read_processed_grid(fp, &output);
+	    std::fclose(fp);
+	    if (!ok) {
+		THROW("Could not process periodically extended grid.");
+	    }
+	    // Make the grid.
+	    buildFromProcessedGrid(output, true, turn_normals);
+	} else if (clip_z) {
+	    std::vector<double> clipped_zcorn(parser.getFloatingPointValue("ZCORN").size());
+	    for (int i = 0; i < int(clipped_zcorn.size()); ++i) {
+		clipped_zcorn[i] = std::max(clip_bot, std::min(clip_top, g.zcorn[i]));
+	    }
+	    g.zcorn = &clipped_zcorn[0];
 	    // Make the grid.
-	    processEclipseFormat(new_g, z_tolerance, true, turn_normals);
+	    processEclipseFormat(g, z_tolerance, false, turn_normals);
 	} else {
 	    // Make the grid.
 	    processEclipseFormat(g, z_tolerance, false, turn_normals);
 	}
+
+	// Store the processed grid in the cache. The file is written
+	// under a temporary name and renamed, so that concurrent runs
+	// never see a partially written grid.
+	if (!cache_file.empty()) {
+	    std::ostringstream tmp_file;
+	    tmp_file << cache_file << ".tmp" << getpid();
+	    try {
+		writeBinaryFile(tmp_file.str(), cache_key);
+		if (std::rename(tmp_file.str().c_str(), cache_file.c_str()) != 0) {
+		    THROW("Could not rename " << tmp_file.str() << " to " << cache_file);
+		}
+	    } catch (const std::exception&) {
+		std::remove(tmp_file.str().c_str());
+		MESSAGE("Could not store processed grid in cache " << cache_file);
+	    }
+	}
     }
 
 
@@ -177,6 +267,17 @@ namespace Dune
 #endif
 	processed_grid output;
 	process_grdecl(&input_data, z_tolerance, &output);
+	buildFromProcessedGrid(output, remove_ij_boundary, turn_normals);
+    }
+
+
+
+
+
+    /// Build the grid from the output of the preprocessing, which is
+    /// released afterwards.
+    void CpGrid::buildFromProcessedGrid(processed_grid& output, bool remove_ij_boundary, bool turn_normals)
+    {
 	if (remove_ij_boundary) {
 	    removeOuterCellLayer(output);
 	}
@@ -192,7 +293,7 @@ namespace Dune
 #ifdef VERBOSE
 	std::cout << "Building geometry." << std::endl;
 #endif
-	buildGeom(output, cell_to_face_, cell_to_point_, face_to_output_face, geometry_, face_normals_, allcorners_, turn_normals);
+	buildGeom(output, cell_to_face_, face_to_output_face, geometry_, face_normals_, turn_normals);
 
 #ifdef VERBOSE
         std::cout << "Assigning face tags." << std::endl;
@@ -214,7 +315,9 @@ namespace Dune
         cartDims_[1] = output.dimensions[1];
         cartDims_[2] = output.dimensions[2];
 
+        applyCellOrdering();
         computeUniqueBoundaryIds();
+        computeHalfFaces();
         
 #ifdef VERBOSE
 	std::cout << "Done with grid processing." << std::endl;
@@ -231,67 +334,153 @@ namespace Dune
     namespace
     {
 
-	typedef boost::array<int, 3> coord_t;
-	typedef boost::array<double, 8> cellz_t;
+	/// Mixes the bytes of [data, data + n) into the 64-bit hash h,
+	/// eight bytes at a time (FNV-1a on words with the given odd
+	/// multiplier, with an extra shift to spread high bits into the
+	/// low ones).
+	boost::uint64_t hashBytes(boost::uint64_t h, boost::uint64_t prime,
+				  const void* data, std::size_t n)
+	{
+	    const char* p = static_cast<const char*>(data);
+	    for (; n >= 8; n -= 8, p += 8) {
+		boost::uint64_t word;
+		std::memcpy(&word, p, 8);
+		h = (h ^ word)*prime;
+		h ^= h >> 29;
+	    }
+	    for (; n > 0; --n, ++p) {
+		h = (h ^ static_cast<unsigned char>(*p))*prime;
+	    }
+	    return h;
+	}
 
-	cellz_t getCellZvals(const coord_t& c, const coord_t& n, const double* z)
+	template <typename T>
+	boost::uint64_t hashValue(boost::uint64_t h, boost::uint64_t prime, const T& value)
 	{
-	    // cout << c << endl;
-	    int delta[3] = { 1,
-			     2*n[0],
-			     4*n[0]*n[1] };
-	    int ix = 2*(c[0]*delta[0] + c[1]*delta[1] + c[2]*delta[2]);
-	    // cout << ix << endl;
-	    cellz_t cellz = {{ z[ix], z[ix + delta[0]],
-			       z[ix + delta[1]], z[ix + delta[1] + delta[0]],
-			       z[ix + delta[2]], z[ix + delta[2] + delta[0]],
-			       z[ix + delta[2] + delta[1]], z[ix + delta[2] + delta[1] + delta[0]] }};
-	    return cellz;
+	    return hashBytes(h, prime, &value, sizeof(T));
 	}
 
 
 
-	void setCellZvals(const coord_t& c, const coord_t& n, double* z, const cellz_t& cellvals)
+	/// Hash of the COORD, ZCORN and ACTNUM data and the processing
+	/// options of a grid, with the given seed and multiplier.
+	boost::uint64_t gridHash(boost::uint64_t h,
+				 boost::uint64_t prime,
+				 const grdecl& g,
+				 int num_coord,
+				 int num_zcorn,
+				 bool has_actnum,
+				 double z_tolerance,
+				 bool periodic_extension,
+				 bool turn_normals,
+				 bool clip_z,
+				 int cell_ordering)
 	{
-	    int delta[3] = { 1,
-			     2*n[0],
-			     4*n[0]*n[1] };
-	    int ix = 2*(c[0]*delta[0] + c[1]*delta[1] + c[2]*delta[2]);
-	    z[ix]                                  = cellvals[0];
-	    z[ix + delta[0]]                       = cellvals[1];
-	    z[ix + delta[1]]                       = cellvals[2];
-	    z[ix + delta[1] + delta[0]]            = cellvals[3];
-	    z[ix + delta[2]]                       = cellvals[4];
-	    z[ix + delta[2] + delta[0]]            = cellvals[5];
-	    z[ix + delta[2] + delta[1]]            = cellvals[6];
-	    z[ix + delta[2] + delta[1] + delta[0]] = cellvals[7];
+	    const int num_cells = g.dims[0]*g.dims[1]*g.dims[2];
+	    h = hashBytes(h, prime, g.dims, sizeof(g.dims));
+	    h = hashValue(h, prime, num_coord);
+	    h = hashValue(h, prime, num_zcorn);
+	    h = hashBytes(h, prime, g.coord, num_coord*sizeof(double));
+	    h = hashBytes(h, prime, g.zcorn, num_zcorn*sizeof(double));
+	    h = hashValue(h, prime, has_actnum);
+	    if (has_actnum) {
+		h = hashBytes(h, prime, g.actnum, num_cells*sizeof(int));
+	    }
+	    h = hashValue(h, prime, z_tolerance);
+	    h = hashValue(h, prime, periodic_extension);
+	    h = hashValue(h, prime, turn_normals);
+	    h = hashValue(h, prime, clip_z);
+	    h = hashValue(h, prime, cell_ordering);
+	    return h;
 	}
 
-	coord_t indexToIjk(const coord_t& n, const int index)
+
+
+	/// Name of the cache file for a grid. The cache key consists of
+	/// two independent hashes of the grid input; the first one names
+	/// the file, and both are stored in its header and checked when
+	/// the file is read, so a file name collision is detected.
+	std::string gridCacheFile(const std::string& cache_dir,
+				  const grdecl& g,
+				  int num_coord,
+				  int num_zcorn,
+				  bool has_actnum,
+				  double z_tolerance,
+				  bool periodic_extension,
+				  bool turn_normals,
+				  bool clip_z,
+				  int cell_ordering,
+				  boost::uint64_t* cache_key)
 	{
-	    coord_t c;
-	    c[2] = index/(n[0]*n[1]);
-	    c[1] = (index%(n[0]*n[1]))/n[0];
-	    c[0] = index%n[0];
-	    return c;
+	    cache_key[0] = gridHash(14695981039346656037ULL, 1099511628211ULL,
+				    g, num_coord, num_zcorn, has_actnum, z_tolerance,
+				    periodic_extension, turn_normals, clip_z, cell_ordering);
+	    cache_key[1] = gridHash(0x243f6a8885a308d3ULL, 0x9e3779b97f4a7c15ULL,
+				    g, num_coord, num_zcorn, has_actnum, z_tolerance,
+				    periodic_extension, turn_normals, clip_z, cell_ordering);
+	    std::ostringstream name;
+	    name << cache_dir << '/' << std::hex << std::setw(16) << std::setfill('0')
+		 << cache_key[0] << ".cpgrid";
+	    return name.str();
 	}
 
-	void findTopAndBottomZ(const coord_t& n, const std::vector<double>& z, double& zb, double& zt)
+
+
+	/// Returns the index of the original cell repeated by cell i of
+	/// a row of n + 2 cells in the extended grid.
+	inline int periodicIndex(int i, int n)
 	{
-	    int numperlevel = 4*n[0]*n[1];
-	    zb = *std::max_element(z.begin(), z.begin() + numperlevel);
-	    zt = *std::min_element(z.end() - numperlevel, z.end());
+	    return (i == 0) ? n - 1 : ((i == n + 1) ? 0 : i - 1);
 	}
 
+	/// Implements grdecl_source::read_rows() for PeriodicSource.
+	int readPeriodicRows(void* ctx, int j0, int j1, double* zcorn, int* actnum)
+	{
+	    const PeriodicSource& src = *static_cast<const PeriodicSource*>(ctx);
+	    const grdecl& g = *src.original;
+	    const int nx = g.dims[0];
+	    const int ny = g.dims[1];
+	    const int nz = g.dims[2];
+	    const int new_nx = nx + 2;
+	    const int new_ny = ny + 2;
+	    const int rows = j1 - j0;
+	    for (int k = 0; k < nz; ++k) {
+		for (int j = j0; j < j1; ++j) {
+		    const int oj = periodicIndex(j, ny);
+		    for (int i = 0; i < new_nx; ++i) {
+			const int oi = periodicIndex(i, nx);
+			const int new_cell = i + new_nx*((j - j0) + rows*k);
+			const int old_cell = oi + nx*(oj + ny*k);
+			const bool boundary = (i == 0 || i == new_nx - 1 || j == 0 || j == new_ny - 1);
+			actnum[new_cell] = (boundary || g.actnum == 0) ? 1 : g.actnum[old_cell];
+			for (int c = 0; c < 8; ++c) {
+			    const int a = c & 1;
+			    const int b = (c >> 1) & 1;
+			    const int h = (c >> 2) & 1;
+			    double z = g.zcorn[(2*oi + a) + 2*nx*((2*oj + b) + 2*ny*(2*k + h))];
+			    z = std::max(src.clip_bot, std::min(src.clip_top, z));
+			    zcorn[(2*i + a) + 2*new_nx*((2*(j - j0) + b) + 2*rows*(2*k + h))]
+				= std::min(src.zt, std::max(src.zb, z));
+			}
+		    }
+		}
+	    }
+	    return 1;
+	}
 
-	/// Add an outer cell layer in the (i, j) directions,
-	/// repeating the cells on the other side (for periodic
-	/// boundary conditions).
-	void addOuterCellLayer(const grdecl& original,
-			       std::vector<double>& new_coord,
-			       std::vector<double>& new_zcorn,
-			       std::vector<int>& new_actnum,
-			       grdecl& output)
+	/// Set up a source for the original grid extended periodically
+	/// with one layer of cells in the (i, j) directions, repeating the
+	/// cells on the other side (for periodic boundary conditions).
+	/// The z values of the original grid are first clipped to
+	/// [clip_bot, clip_top], and the extended grid is then clamped
+	/// to a shoe box. The new cells are all active.
+	/// The original grid must outlive the source.
+	void makePeriodicSource(const grdecl& original,
+				double clip_bot,
+				double clip_top,
+				std::vector<double>& new_coord,
+				PeriodicSource& ctx,
+				grdecl_source& src)
 	{
 	    // Based on periodic_extension.cpp from the old C++ code,
 	    // with a few changes:
@@ -302,110 +491,53 @@ namespace Dune
 
 	    MESSAGE("WARNING: Assuming vertical pillars in a cartesian grid.");
 
-	    // Build new-to-old cell index table.
-	    // First expand in x.
-	    coord_t n = {{ original.dims[0], original.dims[1], original.dims[2] }};
-	    std::vector<int> x_new2old;
-	    x_new2old.reserve((n[0]+2)*n[1]*n[2]);
-	    for (int kz = 0; kz < n[2]; ++kz) {
-		for (int jy = 0; jy < n[1]; ++jy) {
-		    int row_ix = kz*n[0]*n[1] + jy*n[0];
-		    x_new2old.push_back(row_ix + n[0] - 1);
-		    for (int ix = 1; ix < n[0] + 1; ++ix) {
-			x_new2old.push_back(row_ix + ix - 1);
-		    }
-		    x_new2old.push_back(row_ix);
-		}
-	    }
-	    // copy(x_new2old.begin(), x_new2old.end(), ostream_iterator<int>(cout, " "));
-	    // cout << endl;
-	    // Then expand in y.
-	    const int num_new_cells = (n[0]+2)*(n[1]+2)*n[2];
-	    std::vector<int> new2old;
-	    new2old.reserve(num_new_cells);
-	    for (int kz = 0; kz < n[2]; ++kz) {
-		for (int jy = 0; jy < n[1] + 2; ++jy) {
-		    int offset = kz*(n[0] + 2)*n[1] + (jy - 1)*(n[0] + 2);
-		    if (jy == 0) {
-			offset = kz*(n[0] + 2)*n[1] + (n[1] - 1)*(n[0] + 2);
-		    } else if (jy == n[1] + 1) {
-			offset = kz*(n[0] + 2)*n[1];
-		    }
-		    for (int ix = 0; ix < n[0] + 2; ++ix) {
-			new2old.push_back(x_new2old[offset + ix]);
-		    }
-		}
-	    }
-	    ASSERT(int(new2old.size()) == num_new_cells);
-	    // copy(new2old.begin(), new2old.end(), ostream_iterator<int>(cout, " "));
-	    // cout << endl;
-	    // On second thought, we should have used a multidimensional array or something...
-
 	    // Build new COORD field.
-	    std::vector<double> coord;
-	    coord.reserve(6*(n[0] + 3)*(n[1] + 3));
+	    const int nx = original.dims[0];
+	    const int ny = original.dims[1];
+	    const int nz = original.dims[2];
+	    new_coord.clear();
+	    new_coord.reserve(6*(nx + 3)*(ny + 3));
 	    const double* old_coord = original.coord;
 	    double dx = old_coord[6] - old_coord[0];
-	    double dy = old_coord[6*(n[0] + 1) + 1] - old_coord[1];
+	    double dy = old_coord[6*(nx + 1) + 1] - old_coord[1];
 	    double ox = old_coord[0] - dx;
 	    double oy = old_coord[1] - dy;
-	    for (int jy = 0; jy < n[1] + 3; ++jy) {
+	    for (int jy = 0; jy < ny + 3; ++jy) {
 		double y = oy + jy*dy;
-		for (int ix = 0; ix < n[0] + 3; ++ix) {
+		for (int ix = 0; ix < nx + 3; ++ix) {
 		    double x = ox + ix*dx;
-		    coord.push_back(x);
-		    coord.push_back(y);
-		    coord.push_back(0.0);
-		    coord.push_back(x);
-		    coord.push_back(y);
-		    coord.push_back(1.0);
-		}
-	    }
-
-	    // Build new ZCORN field, PERMX, PORO, ACTNUM, SATNUM.
-	    const double* old_zcorn = original.zcorn;
-	    const int* old_actnum = original.actnum;
-	    std::vector<double> zcorn(8*num_new_cells);
-	    std::vector<int> actnum(num_new_cells);
-	    coord_t new_n = {{ n[0] + 2, n[1] + 2, n[2] }};
-	    for (int kz = 0; kz < new_n[2]; ++kz) {
-		for (int jy = 0; jy < new_n[1]; ++jy) {
-		    for (int ix = 0; ix < new_n[0]; ++ix) {
-			int new_cell_index = ix + jy*(new_n[0]) + kz*(new_n[0])*(new_n[1]);
-			int old_cell_index = new2old[new_cell_index];
-			cellz_t cellvals = getCellZvals(indexToIjk(n, old_cell_index), n, old_zcorn);
-			// cout << new_cell_index << ' ' << old_cell_index << ' ' << cellvals << endl;
-			setCellZvals(indexToIjk(new_n, new_cell_index), new_n, &zcorn[0], cellvals);
-			actnum[new_cell_index] = old_actnum[old_cell_index];
-			if (ix == 0 || ix == new_n[0] - 1
-			    || jy == 0 || jy == new_n[1] - 1) {
-			    actnum[new_cell_index] = 1;  // This line is changed from the original.
-			}
-		    }
+		    new_coord.push_back(x);
+		    new_coord.push_back(y);
+		    new_coord.push_back(0.0);
+		    new_coord.push_back(x);
+		    new_coord.push_back(y);
+		    new_coord.push_back(1.0);
 		}
 	    }
 
-	    // Clamp z-coord to make shoe box shape
-	    bool clamp_z = true;
-	    if (clamp_z) {
-		double zb;
-		double zt;
-		findTopAndBottomZ(new_n, zcorn, zb, zt);
-		for (int i = 0; i < int(zcorn.size()); ++i) {
-		    zcorn[i] =  std::min(zt, std::max(zb, zcorn[i]));
-		}
+	    // The extended grid repeats every column of the original,
+	    // so its deepest top and shallowest bottom are those of the
+	    // (clipped) original grid.
+	    const int top_level = 0;
+	    const int bottom_level = 2*nz - 1;
+	    double zb = -1e100;
+	    double zt = 1e100;
+	    for (int i = 0; i < 4*nx*ny; ++i) {
+		zb = std::max(zb, std::max(clip_bot, std::min(clip_top, original.zcorn[i + 4*nx*ny*top_level])));
+		zt = std::min(zt, std::max(clip_bot, std::min(clip_top, original.zcorn[i + 4*nx*ny*bottom_level])));
 	    }
 
-	    // Build output.
-	    new_coord.swap(coord);
-	    new_zcorn.swap(zcorn);
-	    new_actnum.swap(actnum);	
-	    output.dims[0] = new_n[0];
-	    output.dims[1] = new_n[1];
-	    output.dims[2] = new_n[2];
-	    output.coord = &new_coord[0];
-	    output.zcorn = &new_zcorn[0];
-	    output.actnum = &new_actnum[0];
+	    ctx.original = &original;
+	    ctx.clip_bot = clip_bot;
+	    ctx.clip_top = clip_top;
+	    ctx.zb = zb;
+	    ctx.zt = zt;
+	    src.dims[0] = nx + 2;
+	    src.dims[1] = ny + 2;
+	    src.dims[2] = nz;
+	    src.coord = &new_coord[0];
+	    src.ctx = &ctx;
+	    src.read_rows = readPeriodicRows;
 	}
 
 
@@ -482,7 +614,7 @@ namespace Dune
 		       std::vector<int>& global_cell,
 		       cpgrid::OrientedEntityTable<0, 1>& c2f,
 		       cpgrid::OrientedEntityTable<1, 0>& f2c,
-		       SparseTable<int>& f2p,
+		       SparseTable<int, cpgrid::IndexType>& f2p,
 		       std::vector<array<int,8> >& c2p,
 		       std::vector<int>& face_to_output_face)
 	{
@@ -521,8 +653,9 @@ namespace Dune
             int num_cells = c2f.size();
 
             // Build face to point
+	    f2p.clear();
 	    const int* fn = output.face_nodes;
-	    const int* fp = output.face_ptr;
+	    const face_pos_t* fp = output.face_ptr;
 	    for (int face = 0; face < num_faces; ++face) {
 		int output_face = face_to_output_face[face];
                 f2p.appendRow(fn + fp[output_face], fn + fp[output_face+1]);
@@ -536,10 +669,10 @@ namespace Dune
 		// We know that the bottom and top faces come last.
 		int numf = cf.size();
 		int bot_face = face_to_output_face[cf[numf - 2].index()];
-		int bfbegin = output.face_ptr[bot_face];
+		face_pos_t bfbegin = output.face_ptr[bot_face];
 		ASSERT(output.face_ptr[bot_face + 1] - bfbegin == 4);
 		int top_face = face_to_output_face[cf[numf - 1].index()];
-		int tfbegin = output.face_ptr[top_face];
+		face_pos_t tfbegin = output.face_ptr[top_face];
 		ASSERT(output.face_ptr[top_face + 1] - tfbegin == 4);
 		// We want the corners in 'x fastest, then y, then z' order,
 		// so we need to take the face_nodes in noncyclic order: 0 1 3 2.
@@ -592,60 +725,32 @@ namespace Dune
 	    const int* end_;
 	};
 
-	template <int dim>
-	struct MakeGeometry
-	{
-	    cpgrid::Geometry<dim, 3, CpGrid> operator()(const FieldVector<double, 3>& pos, double vol = 1.0)
-	    {
-		return cpgrid::Geometry<dim, 3, CpGrid>(pos, vol);
-	    }
-	};
-
-	template <>
-	struct MakeGeometry<3>
-	{
-	    const FieldVector<double, 3>* allcorners_;
-	    MakeGeometry(const FieldVector<double, 3>* allcorners)
-		: allcorners_(allcorners)
-	    {
-	    }
-	    cpgrid::Geometry<3, 3, CpGrid> operator()(const FieldVector<double, 3>& pos,
-					      double vol,
-					      const array<int,8>& corner_indices)
-	    {
-		return cpgrid::Geometry<3, 3, CpGrid>(pos, vol, allcorners_, &corner_indices[0]);
-	    }
-	};
-
-
-
-
-
 	void buildGeom(const processed_grid& output,
 		       const cpgrid::OrientedEntityTable<0, 1>& c2f,
-		       const std::vector<array<int,8> >& c2p,
 		       const std::vector<int>& face_to_output_face,
 		       cpgrid::DefaultGeometryPolicy<CpGrid>& gpol,
 		       cpgrid::SignedEntityVariable<FieldVector<double, 3>, 1>& normals,
-		       std::vector<FieldVector<double, 3> >& allcorners,
                        bool turn_normals)
 	{
 	    typedef FieldVector<double, 3> point_t;
-	    std::vector<point_t>& points = allcorners;
-	    std::vector<point_t> face_normals;
-	    std::vector<point_t> face_centroids;
-	    std::vector<double>  face_areas;
-	    std::vector<point_t> cell_centroids;
-	    std::vector<double>  cell_volumes;
 	    using namespace GeometryHelpers;
 #ifdef VERBOSE
 	    time::StopWatch clock;
 	    clock.start();
 #endif
-	    // Get the points.
+	    // All loops below write each entity's data straight into
+	    // its final, preallocated slot, so the faces and the cells
+	    // may be processed in parallel. The cell loop only reads
+	    // the face centroids computed by the face loop.
+
 	    int np = output.number_of_nodes;
-	    points.clear();
-	    points.reserve(np);
+	    int nf = face_to_output_face.size();
+	    int nc = output.number_of_cells;
+	    gpol.resize(nc, nf, np);
+
+	    // Get the points.
+	    std::vector<point_t>& points = gpol.points();
+#pragma omp parallel for schedule(static)
 	    for (int i = 0; i < np; ++i) {
 		// \TODO add a convenience explicit constructor
 		// for FieldVector taking an iterator.
@@ -653,125 +758,78 @@ namespace Dune
 		for (int dd = 0; dd < 3; ++dd) {
 		    pt[dd] = output.node_coordinates[3*i + dd];
 		}
-		points.push_back(pt);
+		points[i] = pt;
 	    }
 #ifdef VERBOSE
 	    std::cout << "Points:             " << clock.secsSinceLast() << std::endl;
 #endif
 
 	    // Get the face data.
-	    // \TODO Both the face and (especially) the cell section
-	    // is not very efficient. It could be rewritten easily
-	    // (focus on the polygonCellXXX methods first).
 	    // \TODO Use exact geometry instead of these approximations.
-	    int nf = face_to_output_face.size();
 	    const int* fn = output.face_nodes;
-	    const int* fp = output.face_ptr;
+	    const face_pos_t* fp = output.face_ptr;
+	    const double normal_sign = turn_normals ? -1.0 : 1.0;
+	    std::vector<point_t> face_centroids(nf);
+	    normals.resize(nf);
+	    std::vector<point_t>::iterator fnormal = normals.begin();
+#pragma omp parallel for schedule(static)
 	    for (int face = 0; face < nf; ++face) {
-		// Computations in this loop could be speeded up
-		// by doing more of them simultaneously.
 		int output_face = face_to_output_face[face];
 		IndirectArray<point_t> face_pts(points, fn + fp[output_face], fn + fp[output_face+1]);
 		point_t avg = average(face_pts);
 		point_t centroid = polygonCentroid(face_pts, avg);
 		point_t normal = polygonNormal(face_pts, centroid);
+		normal *= normal_sign;
 		double area = polygonArea(face_pts, centroid);
-		face_normals.push_back(normal);
-		face_centroids.push_back(centroid);
-		face_areas.push_back(area);
+		face_centroids[face] = centroid;
+		gpol.setFace(face, centroid, area);
+		fnormal[face] = normal;
 	    }
 #ifdef VERBOSE
 	    std::cout << "Faces:              " << clock.secsSinceLast() << std::endl;
 #endif
+
 	    // Get the cell data.
-	    int nc = output.number_of_cells;
-	    std::vector<int> face_indices;
-	    for (int cell = 0; cell < nc; ++cell) {
-		cpgrid::EntityRep<0> cell_ent(cell, true);
-		cpgrid::OrientedEntityTable<0, 1>::row_type cf = c2f[cell_ent];
-		face_indices.clear();
-		for (int local_index = 0; local_index < cf.size(); ++local_index) {
-		    face_indices.push_back(cf[local_index].index());
-		}
-		IndirectArray<point_t> cell_pts(face_centroids, &face_indices[0], &face_indices[0] + cf.size());
-		point_t cell_avg = average(cell_pts);
-		point_t cell_centroid(0.0);
-		double tot_cell_vol = 0.0;
-		for (int local_index = 0; local_index < cf.size(); ++local_index) {
-		    int face = cf[local_index].index();
-		    int output_face = face_to_output_face[face];
-		    IndirectArray<point_t> face_pts(points, fn + fp[output_face], fn + fp[output_face+1]);
-		    double small_vol = polygonCellVolume(face_pts, face_centroids[face], cell_avg);
-		    tot_cell_vol += small_vol;
-		    point_t face_contrib = polygonCellCentroid(face_pts, face_centroids[face], cell_avg);
-		    face_contrib *= small_vol;
-		    cell_centroid += face_contrib;
-		}
-		cell_centroid /= tot_cell_vol;
+	    // \TODO The polygonCellXXX methods could be made more efficient.
+#pragma omp parallel
+	    {
+		std::vector<int> face_indices;
+#pragma omp for schedule(static)
+		for (int cell = 0; cell < nc; ++cell) {
+		    cpgrid::EntityRep<0> cell_ent(cell, true);
+		    cpgrid::OrientedEntityTable<0, 1>::row_type cf = c2f[cell_ent];
+		    face_indices.clear();
+		    for (int local_index = 0; local_index < cf.size(); ++local_index) {
+			face_indices.push_back(cf[local_index].index());
+		    }
+		    IndirectArray<point_t> cell_pts(face_centroids, &face_indices[0], &face_indices[0] + cf.size());
+		    point_t cell_avg = average(cell_pts);
+		    point_t cell_centroid(0.0);
+		    double tot_cell_vol = 0.0;
+		    for (int local_index = 0; local_index < cf.size(); ++local_index) {
+			int face = cf[local_index].index();
+			int output_face = face_to_output_face[face];
+			IndirectArray<point_t> face_pts(points, fn + fp[output_face], fn + fp[output_face+1]);
+			double small_vol = polygonCellVolume(face_pts, face_centroids[face], cell_avg);
+			tot_cell_vol += small_vol;
+			point_t face_contrib = polygonCellCentroid(face_pts, face_centroids[face], cell_avg);
+			face_contrib *= small_vol;
+			cell_centroid += face_contrib;
+		    }
+		    cell_centroid /= tot_cell_vol;
 // #define HACK_CELL_CENTROIDS     // when this is defined, you get the average of top and bottom face centroids.
 #ifdef HACK_CELL_CENTROIDS
-                int numf = cf.size();
-                cell_centroid = face_centroids[face_indices[numf - 2]];
-                cell_centroid += face_centroids[face_indices[numf - 1]];
-                cell_centroid *= 0.5;
+		    int numf = cf.size();
+		    cell_centroid = face_centroids[face_indices[numf - 2]];
+		    cell_centroid += face_centroids[face_indices[numf - 1]];
+		    cell_centroid *= 0.5;
 #endif
-		cell_centroids.push_back(cell_centroid);
-		cell_volumes.push_back(tot_cell_vol);
+		    gpol.setCell(cell, cell_centroid, tot_cell_vol);
+		}
 	    }
 #ifdef VERBOSE
 	    std::cout << "Cells:              " << clock.secsSinceLast() << std::endl;
 #endif
-
-
-	    // \TODO Fix the code below , as it is:
-	    // A) wasteful
-	    // B) wordy,
-	    // C) slow
-	    // D) copied from readSintefLegacyFormat.cpp
-	    // Cells
-	    cpgrid::EntityVariable<cpgrid::Geometry<3, 3, CpGrid>, 0> cellgeom;
-	    std::vector<cpgrid::Geometry<3, 3, CpGrid> > cg;
-	    cg.reserve(nc);
-	    MakeGeometry<3> mcellg(&allcorners[0]);
-// 	    std::transform(cell_centroids.begin(), cell_centroids.end(),
-// 			   cell_volumes.begin(),
-// 			   std::back_inserter(cg), mcellg);
-	    for (int c = 0;  c < nc; ++c) {
-		cg.push_back(mcellg(cell_centroids[c], cell_volumes[c], c2p[c]));
-	    }
-	    cellgeom.assign(cg.begin(), cg.end());
-	    // Faces
-	    cpgrid::EntityVariable<cpgrid::Geometry<2, 3, CpGrid>, 1> facegeom;
-	    std::vector<cpgrid::Geometry<2, 3, CpGrid> > fg;
-	    MakeGeometry<2> mfaceg;
-	    std::transform(face_centroids.begin(), face_centroids.end(),
-			   face_areas.begin(),
-			   std::back_inserter(fg), mfaceg);
-	    facegeom.assign(fg.begin(), fg.end());
-	    // Points
-	    cpgrid::EntityVariable<cpgrid::Geometry<0, 3, CpGrid>, 3> pointgeom;
-	    std::vector<cpgrid::Geometry<0, 3, CpGrid> > pg;
-	    MakeGeometry<0> mpointg;
-	    std::transform(points.begin(), points.end(),
-			   std::back_inserter(pg), mpointg);
-	    pointgeom.assign(pg.begin(), pg.end());
-#ifdef VERBOSE
-	    std::cout << "Transforms/copies:  " << clock.secsSinceLast() << std::endl;
-#endif
-
-	    // The final, combined object (yes, a lot of copying goes on here).
-            if (turn_normals) {
-                int num_normals = face_normals.size();
-                for (int i = 0; i < num_normals; ++i) {
-                    face_normals[i] *= -1.0;
-                }
-            }
-	    cpgrid::DefaultGeometryPolicy<CpGrid> gp(cellgeom, facegeom, pointgeom);
-	    gpol = gp;
-	    normals.assign(face_normals.begin(), face_normals.end());
-#ifdef VERBOSE
-	    std::cout << "Final construction: " << clock.secsSinceLast() << std::endl;
-#endif
 	}
 
 
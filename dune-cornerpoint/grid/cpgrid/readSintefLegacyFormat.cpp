@@ -97,6 +97,7 @@ namespace Dune
             }
         }
         computeUniqueBoundaryIds();
+        computeHalfFaces();
     }
 
 
@@ -197,24 +198,6 @@ namespace Dune
 	} // void readTopo()
 
 
-	template <int dim>
-	struct MakeGeometry
-	{
-	    cpgrid::Geometry<dim, 3, CpGrid> operator()(const FieldVector<double, 3> pos, double vol = 1.0)
-	    {
-		return cpgrid::Geometry<dim, 3, CpGrid>(pos, vol);
-	    }
-	};
-
-// 	template <>
-// 	struct MakeGeometry<0>
-// 	{
-// 	    cpgrid::Geometry<0, 3> operator()(const FieldVector<double, 3> pos)
-// 	    {
-// 		return cpgrid::Geometry<dim, 3>(pos, vo);
-// 	    }
-// 	};
-
 	void readGeom(std::istream& geom,
 		      cpgrid::DefaultGeometryPolicy<CpGrid>& gpol,
 		      cpgrid::SignedEntityVariable<FieldVector<double, 3> , 1>& normals)
@@ -296,34 +279,17 @@ namespace Dune
 		geom >> cell_volumes[i];
 	    }
 
-	    // Code below has been copied to readEclipseFormat: \TODO Refactor!
-	    // Cells
-	    cpgrid::EntityVariable<cpgrid::Geometry<3, 3, CpGrid>, 0> cellgeom;
-	    std::vector<cpgrid::Geometry<3, 3, CpGrid> > cg;
-	    MakeGeometry<3> mcellg;
-	    std::transform(cell_centroids.begin(), cell_centroids.end(),
-			   cell_volumes.begin(),
-			   std::back_inserter(cg), mcellg);
-	    cellgeom.assign(cg.begin(), cg.end());
-	    // Faces
-	    cpgrid::EntityVariable<cpgrid::Geometry<2, 3, CpGrid>, 1> facegeom;
-	    std::vector<cpgrid::Geometry<2, 3, CpGrid> > fg;
-	    MakeGeometry<2> mfaceg;
-	    std::transform(face_centroids.begin(), face_centroids.end(),
-			   face_areas.begin(),
-			   std::back_inserter(fg), mfaceg);
-	    facegeom.assign(fg.begin(), fg.end());
-	    // Points
-	    cpgrid::EntityVariable<cpgrid::Geometry<0, 3, CpGrid>, 3> pointgeom;
-	    std::vector<cpgrid::Geometry<0, 3, CpGrid> > pg;
-	    MakeGeometry<0> mpointg;
-	    std::transform(points.begin(), points.end(),
-			   std::back_inserter(pg), mpointg);
-	    pointgeom.assign(pg.begin(), pg.end());
-
-	    // The final, combined object (yes, a lot of copying goes on here).
-	    cpgrid::DefaultGeometryPolicy<CpGrid> gp(cellgeom, facegeom, pointgeom);
-	    gpol = gp;
+	    // The final, combined object.
+	    cpgrid::DefaultGeometryPolicy<CpGrid> gp;
+	    gp.resize(num_cells, num_faces, num_points);
+	    for (int i = 0; i < num_cells; ++i) {
+		gp.setCell(i, cell_centroids[i], cell_volumes[i]);
+	    }
+	    for (int i = 0; i < num_faces; ++i) {
+		gp.setFace(i, face_centroids[i], face_areas[i]);
+	    }
+	    gp.points().swap(points);
+	    gpol.swap(gp);
 	    normals.assign(face_normals.begin(), face_normals.end());
 	}
 
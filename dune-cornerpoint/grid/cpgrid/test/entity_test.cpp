@@ -91,3 +91,41 @@ BOOST_AUTO_TEST_CASE(entity_ptr)
 //     BOOST_CHECK(e2 == ee2);
 }
 
+
+BOOST_AUTO_TEST_CASE(geometry_policy)
+{
+    typedef cpgrid::DefaultGeometryPolicy<CpGrid> Policy;
+    typedef FieldVector<double, 3> Point;
+    Policy p;
+    p.resize(2, 3, 8);
+    BOOST_CHECK_EQUAL(p.size<0>(), 2);
+    BOOST_CHECK_EQUAL(p.size<1>(), 3);
+    BOOST_CHECK_EQUAL(p.size<3>(), 8);
+    p.setCell(1, Point(1.0), 2.5);
+    p.setFace(2, Point(3.0), 0.5);
+    for (int i = 0; i < 8; ++i) {
+        p.points()[i] = Point(double(i));
+    }
+    // Component arrays are stored separately.
+    BOOST_CHECK_EQUAL(p.cellCentroids(2)[1], 1.0);
+    BOOST_CHECK_EQUAL(p.cellVolumes()[1], 2.5);
+    BOOST_CHECK_EQUAL(p.faceCentroids(0)[2], 3.0);
+    BOOST_CHECK_EQUAL(p.faceAreas()[2], 0.5);
+
+    // Geometries are assembled on demand from the arrays.
+    const int corners[8] = { 7, 6, 5, 4, 3, 2, 1, 0 };
+    cpgrid::Geometry<3, 3, CpGrid> cg = p.geometry<0>(1, corners);
+    BOOST_CHECK_EQUAL(cg.volume(), 2.5);
+    BOOST_CHECK_EQUAL(cg.center()[2], 1.0);
+    BOOST_CHECK_EQUAL(cg.corner(0)[0], 7.0);
+    cpgrid::Geometry<2, 3, CpGrid> fg = p.geometry<1>(2);
+    BOOST_CHECK_EQUAL(fg.volume(), 0.5);
+    BOOST_CHECK_EQUAL(fg.center()[1], 3.0);
+    cpgrid::Geometry<0, 3, CpGrid> pg = p.geometry<3>(5);
+    BOOST_CHECK_EQUAL(pg.center()[0], 5.0);
+
+    Policy q;
+    q.swap(p);
+    BOOST_CHECK_EQUAL(q.size<0>(), 2);
+    BOOST_CHECK_EQUAL(p.size<3>(), 0);
+}
@@ -70,7 +70,26 @@ BOOST_AUTO_TEST_CASE(entity_rep)
     BOOST_CHECK(!(e1 == e2));
     BOOST_CHECK(e1 != e2);
     BOOST_CHECK(!(e1 != e1));
-    BOOST_CHECK_EQUAL(sizeof e1, sizeof(int));
+    BOOST_CHECK_EQUAL(sizeof e1, sizeof(cpgrid::IndexType));
+}
+
+BOOST_AUTO_TEST_CASE(entity_rep_64bit)
+{
+    typedef boost::int64_t Index;
+    const Index big = Index(3) << 31;
+    cpgrid::EntityRep<0, Index> e1(big, true);
+    cpgrid::EntityRep<0, Index> e2(big, false);
+    cpgrid::EntityRep<0, Index> e3(big + 1, true);
+    BOOST_CHECK(e1.orientation());
+    BOOST_CHECK(!e2.orientation());
+    BOOST_CHECK_EQUAL(e1.index(), big);
+    BOOST_CHECK_EQUAL(e2.index(), big);
+    BOOST_CHECK(e1.opposite() == e2);
+    BOOST_CHECK(e1 < e2);
+    BOOST_CHECK(e2 < e3);
+    BOOST_CHECK(e1 != e3);
+    BOOST_CHECK_EQUAL(sizeof e1, sizeof(Index));
+    BOOST_CHECK(e1.index() < (cpgrid::EntityRep<0, Index>::InvalidIndex));
 }
 
 BOOST_AUTO_TEST_CASE(entity_variable)
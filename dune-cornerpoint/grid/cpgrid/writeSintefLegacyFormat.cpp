@@ -53,7 +53,7 @@ namespace Dune
 	void writeTopo(std::ostream& topo,
                        const cpgrid::OrientedEntityTable<0, 1>& c2f,
                        const cpgrid::OrientedEntityTable<1, 0>& f2c,
-                       const SparseTable<int>& f2p,
+                       const SparseTable<int, cpgrid::IndexType>& f2p,
                        const std::vector<array<int,8> >& c2p,
                        const int num_points);
 	void writeGeom(std::ostream& geom,
@@ -77,7 +77,7 @@ namespace Dune
 	    if (!file) {
 		THROW("Could not open file " << topofilename);
 	    }
-	    writeTopo(file, cell_to_face_, face_to_cell_, face_to_point_, cell_to_point_, allcorners_.size());
+	    writeTopo(file, cell_to_face_, face_to_cell_, face_to_point_, cell_to_point_, geometry_.points().size());
 	}
 	std::string geomfilename = grid_prefix + "-geom.dat";
 	{
@@ -101,7 +101,7 @@ namespace Dune
 	    if (!file) {
 		THROW("Could not open file " << vtkfilename);
 	    }
-            writeVtkVolumes(file, allcorners_, cell_to_point_);
+            writeVtkVolumes(file, geometry_.points(), cell_to_point_);
         }
     }
 
@@ -114,7 +114,7 @@ namespace Dune
 	void writeTopo(std::ostream& topo,
                        const cpgrid::OrientedEntityTable<0, 1>& c2f,
                        const cpgrid::OrientedEntityTable<1, 0>& f2c,
-                       const SparseTable<int>& f2p,
+                       const SparseTable<int, cpgrid::IndexType>& f2p,
                        const std::vector<array<int,8> >& c2p,
                        const int num_points)
 	{
@@ -159,7 +159,7 @@ namespace Dune
 
 	    // Write faces to points mapping
 	    for (int face = 0; face < num_faces; ++face) {
-                SparseTable<int>::row_type fp = f2p[face];
+                SparseTable<int, cpgrid::IndexType>::row_type fp = f2p[face];
                 int nump = fp.size();
                 topo << nump;
 		for (int j = 0; j < nump; ++j) {
@@ -183,16 +183,16 @@ namespace Dune
             geom << correct_header;
 
 	    // Write points.
-	    int num_points = gpol.geomVector<3>().size();
+	    int num_points = gpol.size<3>();
 	    geom << num_points << '\n';
 	    for (int i = 0; i < num_points; ++i) {
-		geom << gpol.geomVector<3>()[cpgrid::EntityRep<3>(i,true)].center() << '\n';
+		geom << gpol.points()[i] << '\n';
 	    }
             geom << '\n';
 
 	    // Write face normals
-            ASSERT(gpol.geomVector<1>().size() == normals.size());
-	    int num_faces = gpol.geomVector<1>().size();
+            ASSERT(gpol.size<1>() == int(normals.size()));
+	    int num_faces = gpol.size<1>();
 	    geom << num_faces << '\n';
 	    for (int i = 0; i < num_faces; ++i) {
 		geom << normals[cpgrid::EntityRep<1>(i, true)] << '\n';
@@ -201,26 +201,26 @@ namespace Dune
 	    // Write face centroids
 	    geom << num_faces << '\n';
 	    for (int i = 0; i < num_faces; ++i) {
-		geom << gpol.geomVector<1>()[cpgrid::EntityRep<1>(i, true)].center() << '\n';
+		geom << gpol.faceCentroid(i) << '\n';
 	    }
             geom << '\n';
 	    // Write face areas
 	    geom << num_faces << '\n';
 	    for (int i = 0; i < num_faces; ++i) {
-		geom << gpol.geomVector<1>()[cpgrid::EntityRep<1>(i, true)].volume() << '\n';
+		geom << gpol.faceAreas()[i] << '\n';
 	    }
             geom << '\n';
 	    // Write cell centroids
-	    int num_cells = gpol.geomVector<0>().size();
+	    int num_cells = gpol.size<0>();
 	    geom << num_cells << '\n';
 	    for (int i = 0; i < num_cells; ++i) {
-		geom << gpol.geomVector<0>()[cpgrid::EntityRep<0>(i, true)].center() << '\n';
+		geom << gpol.cellCentroid(i) << '\n';
 	    }
             geom << '\n';
 	    // Write cell volumes
 	    geom << num_cells << '\n';
 	    for (int i = 0; i < num_cells; ++i) {
-		geom << gpol.geomVector<0>()[cpgrid::EntityRep<0>(i, true)].volume() << '\n';
+		geom << gpol.cellVolumes()[i] << '\n';
 	    }
 	}
 
@@ -201,7 +201,21 @@ faceintersection(const int *a1, const int *a2,
      ! ((a1[i+1] == INT_MAX) && (b1[j+1] == INT_MAX)))
 
 
-/* work should be pointer to 2n ints initialised to zero . */
+/* Reset entries [range[0], range[1]] of intersection record to -1. */
+static void
+reset_record(int *record, int range[2])
+{
+    int j;
+
+    for (j = range[0]; j <= range[1]; ++j) { record[j] = -1; }
+
+    range[0] = INT_MAX;
+    range[1] = -1;
+}
+
+
+/* work should be pointer to 2n ints initialised to -1.  On return,
+ * work is reset to -1. */
 void findconnections(int n, int *pts[4],
                      int *intersectionlist,
                      int *work,
@@ -219,6 +233,13 @@ void findconnections(int n, int *pts[4],
     int *f       = out->face_nodes + out->face_ptr[out->number_of_faces];
     int *c       = out->face_neighbors + 2*out->number_of_faces;
 
+    /* Range of entries set in each intersection record.  Only these
+     * need resetting, which keeps the work per pillar pair
+     * proportional to the number of face candidates rather than n^2. */
+    int  range[2][2];
+    int *rtop    = range[0];
+    int *rbottom = range[1];
+
     int k1  = 0;
     int k2  = 0;
 
@@ -229,6 +250,9 @@ void findconnections(int n, int *pts[4],
 
     for (i = 0; i < 4; i++) { intersect[i] = -1; }
 
+    rtop[0]    = rbottom[0] = INT_MAX;
+    rtop[1]    = rbottom[1] = -1;
+
     for (i = 0; i < n - 1; ++i) {
 
         /* pinched a-cell */
@@ -242,6 +266,10 @@ void findconnections(int n, int *pts[4],
                ((b1[j] < a1[i + 1]) ||
                 (b2[j] < a2[i + 1])))
         {
+            /* itop[j+1] may be set below */
+            rtop[0] = MIN(rtop[0], j + 1);
+            rtop[1] = MAX(rtop[1], j + 1);
+
             /* pinched b-cell */
             if ((b1[j] == b1[j + 1]) &&
                 (b2[j] == b2[j + 1])) {
@@ -354,13 +382,17 @@ void findconnections(int n, int *pts[4],
         /* Swap intersection records: top line of a[i,i+1] is bottom
          * line of a[i+1,i+2] */
         tmp = itop; itop = ibottom; ibottom = tmp;
+        tmp = rtop; rtop = rbottom; rbottom = tmp;
 
         /* Zero out the "new" itop */
-        for(j=0;j<n; ++j) { itop[j]=-1; }
+        reset_record(itop, rtop);
 
         /* Set j to appropriate start position for next i */
         j = MIN(k1, k2);
     }
+
+    reset_record(itop   , rtop   );
+    reset_record(ibottom, rbottom);
 }
 
 /* Local Variables:    */
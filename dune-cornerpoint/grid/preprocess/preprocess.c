@@ -39,6 +39,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "preprocess.h"
 #include "uniquepoints.h"
 #include "facetopology.h"
@@ -50,17 +54,14 @@
 static void
 compute_cell_index(const int dims[3], int i, int j, int *neighbors, int len);
 
-static int
-checkmemory(int nz, struct processed_grid *out, int **intersections);
-
 static void
-process_vertical_faces(int direction,
-                       int **intersections,
+process_vertical_faces(int direction, int jstart, int jend,
+                       int *intersections,
                        int *plist, int *work,
                        struct processed_grid *out);
 
 static void
-process_horizontal_faces(int **intersections,
+process_horizontal_faces(int jstart, int jend,
                          int *plist,
                          struct processed_grid *out);
 
@@ -134,62 +135,34 @@ compute_cell_index(const int dims[3], int i, int j,
 
 
 /*-----------------------------------------------------------------
-  Ensure there's sufficient memory */
-static int
-checkmemory(int nz, struct processed_grid *out, int **intersections)
+  Find point numbers on the pillar pair shared by cells (i-1+direction,
+  j-direction) and (i,j), oriented such that direction == 1 faces are
+  processed as direction == 0 faces.
+*/
+static void
+get_pillar_pair(int direction, int i, int j, int d[3],
+                int *plist, int *cornerpts[4])
 {
-    int r, m, n, ok;
-
-    /* Ensure there is enough space to manage the (pathological) case
-     * of every single cell on one side of a fault connecting to all
-     * cells on the other side of the fault (i.e., an all-to-all cell
-     * connectivity pairing). */
-    r = (2*nz + 2) * (2*nz + 2);
-    m = out->m;
-    n = out->n;
-
-    if (out->number_of_faces +  r > m) {
-        m += MAX(m / 2,  2 * r);
-    }
-    if (out->face_ptr[out->number_of_faces] + 6*r > n) {
-        n += MAX(n / 2, 12 * r);
-    }
-
-    ok = m == out->m;
-    if (! ok) {
-        void *p1, *p2, *p3, *p4;
-
-        p1 = realloc(*intersections     , 4*m   * sizeof **intersections);
-        p2 = realloc(out->face_neighbors, 2*m   * sizeof *out->face_neighbors);
-        p3 = realloc(out->face_ptr      , (m+1) * sizeof *out->face_ptr);
-        p4 = realloc(out->face_tag      , 1*m   * sizeof *out->face_tag);
-
-        if (p1 != NULL) { *intersections      = p1; }
-        if (p2 != NULL) { out->face_neighbors = p2; }
-        if (p3 != NULL) { out->face_ptr       = p3; }
-        if (p4 != NULL) { out->face_tag       = p4; }
-
-        ok = (p1 != NULL) && (p2 != NULL) && (p3 != NULL) && (p4 != NULL);
+    int *tmp;
 
-        if (ok) { out->m = m; }
+    /* Vectors of point numbers */
+    igetvectors(d, 2*i + direction, 2*j + (1 - direction),
+                plist, cornerpts);
+
+    if (direction == 1) {
+        /* 1   3       0   1    */
+        /*       --->           */
+        /* 0   2       2   3    */
+        /* rotate clockwise     */
+        tmp          = cornerpts[1];
+        cornerpts[1] = cornerpts[0];
+        cornerpts[0] = cornerpts[2];
+        cornerpts[2] = cornerpts[3];
+        cornerpts[3] = tmp;
     }
-
-    if (ok && (n != out->n)) {
-        void *p1;
-
-        p1 = realloc(out->face_nodes, n * sizeof *out->face_nodes);
-
-        ok = p1 != NULL;
-
-        if (ok) {
-            out->face_nodes = p1;
-            out->n          = n;
-        }
-    }
-
-    return ok;
 }
 
+
 /*-----------------------------------------------------------------
   For each vertical face (i.e. i or j constant),
   -find point numbers for the corners and
@@ -198,10 +171,12 @@ checkmemory(int nz, struct processed_grid *out, int **intersections)
 
   direction == 0 : constant-i faces.
   direction == 1 : constant-j faces.
+
+  Only pillar rows j in [jstart, jend) are processed.
 */
 static void
-process_vertical_faces(int direction,
-                       int **intersections,
+process_vertical_faces(int direction, int jstart, int jend,
+                       int *intersections,
                        int *plist, int *work,
                        struct processed_grid *out)
 {
@@ -210,7 +185,6 @@ process_vertical_faces(int direction,
     int d[3];
     int f;
     enum face_tag tag[] = { LEFT, BACK };
-    int *tmp;
     int nx = out->dimensions[0];
     int ny = out->dimensions[1];
     int nz = out->dimensions[2];
@@ -225,31 +199,10 @@ process_vertical_faces(int direction,
     d[1] = 2 * (ny + 0);
     d[2] = 2 * (nz + 1);
 
-    for (j = 0; j < ny + direction; ++j) {
+    for (j = jstart; j < jend; ++j) {
         for (i = 0; i < nx + (1 - direction); ++i) {
 
-            if (! checkmemory(nz, out, intersections)) {
-                fprintf(stderr,
-                        "Could not allocate enough space in "
-                        "process_vertical_faces()\n");
-                exit(1);
-            }
-
-            /* Vectors of point numbers */
-            igetvectors(d, 2*i + direction, 2*j + (1 - direction),
-                        plist, cornerpts);
-
-            if (direction == 1) {
-                /* 1   3       0   1    */
-                /*       --->           */
-                /* 0   2       2   3    */
-                /* rotate clockwise     */
-                tmp          = cornerpts[1];
-                cornerpts[1] = cornerpts[0];
-                cornerpts[0] = cornerpts[2];
-                cornerpts[2] = cornerpts[3];
-                cornerpts[3] = tmp;
-            }
+            get_pillar_pair(direction, i, j, d, plist, cornerpts);
 
             /* int startface = ftab->position; */
             startface = out->number_of_faces;
@@ -259,7 +212,7 @@ process_vertical_faces(int direction,
 
             /* Establish new connections (faces) along pillar pair. */
             findconnections(2*nz + 2, cornerpts,
-                            *intersections + 4*num_intersections,
+                            intersections + 4*num_intersections,
                             work, out);
 
             /* Start of ->face_neighbors[] for this set of connections. */
@@ -295,9 +248,11 @@ process_vertical_faces(int direction,
   cells that are have collapsed coordinates. (This includes cells with
   ACTNUM==0)
 
+  Only cell rows j in [jstart, jend) are processed.  Active cells are
+  counted from out->number_of_cells onwards.
 */
 static void
-process_horizontal_faces(int **intersections,
+process_horizontal_faces(int jstart, int jend,
                          int *plist,
                          struct processed_grid *out)
 {
@@ -308,7 +263,7 @@ process_horizontal_faces(int **intersections,
     int nz = out->dimensions[2];
 
     int *cell  = out->local_cell_index;
-    int cellno = 0;
+    int cellno = out->number_of_cells;
     int *f, *n, *c[4];
     int prevcell, thiscell;
     int idx;
@@ -320,18 +275,9 @@ process_horizontal_faces(int **intersections,
     d[2] = 2+2*nz;
 
 
-    for(j=0; j<ny; ++j) {
+    for(j=jstart; j<jend; ++j) {
         for (i=0; i<nx; ++i) {
 
-
-            if (! checkmemory(nz, out, intersections)) {
-                fprintf(stderr,
-                        "Could not allocate enough space in "
-                        "process_horizontal_faces()\n");
-                exit(1);
-            }
-
-
             f = out->face_nodes     + out->face_ptr[out->number_of_faces];
             n = out->face_neighbors + 2*out->number_of_faces;
 
@@ -556,6 +502,40 @@ copy_and_permute_zcorn(int nx, int ny, int nz, const double *in,
     return out;
 }
 
+/* ------------------------------------------------------------------ */
+static int
+zcorn_is_nondecreasing(int nx, int ny, int nz, const int *actnum,
+                       const double *zcorn, int sign)
+/* ------------------------------------------------------------------ */
+{
+    /* Check whether sign*z(i,j,k) <= sign*z(i,j,k+1) for all active
+       (i,j,k). */
+    int    i, j, k;
+    int    c1, c2;
+    double z1, z2;
+
+    for (j=0; j<2*ny; ++j){
+        for (i=0; i<2*nx; ++i){
+            for (k=0; k<2*nz-1; ++k){
+                z1 = sign*zcorn[i+2*nx*(j+2*ny*(k))];
+                z2 = sign*zcorn[i+2*nx*(j+2*ny*(k+1))];
+
+                c1 = i/2 + nx*(j/2 + ny*(k/2));
+                c2 = i/2 + nx*(j/2 + ny*((k+1)/2));
+
+                if (((actnum == NULL) ||
+                     (actnum[c1] && actnum[c2]))
+                    && (z2 < z1)) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+
 /* ------------------------------------------------------------------ */
 static int
 get_zcorn_sign(int nx, int ny, int nz, const int *actnum,
@@ -573,40 +553,17 @@ get_zcorn_sign(int nx, int ny, int nz, const int *actnum,
 
     */
     int    sign;
-    int    i, j, k;
-    int    c1, c2;
-    double z1, z2;
 
     for (sign = 1; sign>-2; sign = sign - 2)
     {
-        *error = 0;
-
-        for (j=0; j<2*ny; ++j){
-            for (i=0; i<2*nx; ++i){
-                for (k=0; k<2*nz-1; ++k){
-                    z1 = sign*zcorn[i+2*nx*(j+2*ny*(k))];
-                    z2 = sign*zcorn[i+2*nx*(j+2*ny*(k+1))];
-
-                    c1 = i/2 + nx*(j/2 + ny*(k/2));
-                    c2 = i/2 + nx*(j/2 + ny*((k+1)/2));
-
-                    if (((actnum == NULL) ||
-                         (actnum[c1] && actnum[c2]))
-                        && (z2 < z1)) {
+        *error = ! zcorn_is_nondecreasing(nx, ny, nz, actnum, zcorn, sign);
 
-                        fprintf(stderr, "\nZCORN should be strictly "
-                                "nondecreasing along pillars!\n");
-                        *error = 1;
-                        goto end;
-                    }
-                }
-            }
-        }
-
-    end:
         if (!*error){
             break;
         }
+
+        fprintf(stderr, "\nZCORN should be strictly "
+                "nondecreasing along pillars!\n");
     }
 
     if (*error){
@@ -666,15 +623,14 @@ vert_size(const struct grdecl *in,
 
 /* ---------------------------------------------------------------------- */
 static int
-is_lefthanded(const struct grdecl *in)
+find_vertical_size(const struct grdecl *in, size_t *c, double *dz)
 /* ---------------------------------------------------------------------- */
 {
+    /* Find first active cell, in natural ordering, of nonzero vertical
+     * size.  Returns zero if there is no such cell. */
     int           active, searching;
-    size_t        nx, ny, nz, c;
-    size_t        origin, imax, jmax;
+    size_t        nx, ny, nz;
     size_t        off[8];
-    double        dx[2], dy[2], dz, triple;
-    const double *pt_coord;
 
     nx = in->dims[0];
     ny = in->dims[1];
@@ -689,6 +645,38 @@ is_lefthanded(const struct grdecl *in)
     off[6] = off[4] + (2 * nx);
     off[7] = off[6] + 1;
 
+    *c = 0;  *dz = 0.0;
+    do {
+        active = (in->actnum == NULL) || (in->actnum[*c] != 0);
+
+        if (active) {
+            *dz = vert_size(in, *c, off);
+        }
+
+        searching = ! (active && (fabs(*dz) > 0.0));
+
+        *c += 1;
+    } while (searching && (*c < (nx * ny * nz)));
+
+    *c -= 1;
+
+    return ! searching;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+is_lefthanded_dz(const struct grdecl *in, double dz)
+/* ---------------------------------------------------------------------- */
+{
+    size_t        nx, ny;
+    size_t        origin, imax, jmax;
+    double        dx[2], dy[2], triple;
+    const double *pt_coord;
+
+    nx = in->dims[0];
+    ny = in->dims[1];
+
     pt_coord = in->coord;
 
     origin = 0;
@@ -701,21 +689,6 @@ is_lefthanded(const struct grdecl *in)
     dx[1] = pt_coord[jmax + 0] - pt_coord[origin + 0];
     dy[1] = pt_coord[jmax + 1] - pt_coord[origin + 1];
 
-    c = 0;  dz = 0.0;
-    do {
-        active = (in->actnum == NULL) || (in->actnum[c] != 0);
-
-        if (active) {
-            dz = vert_size(in, c, off);
-        }
-
-        searching = ! (active && (fabs(dz) > 0.0));
-
-        c += 1;
-    } while (searching && (c < (nx * ny * nz)));
-
-    assert (! searching);       /* active && (fabs(dz) > 0) */
-
     /* Compute vector triple product to distinguish left-handed (<0)
      * from right-handed (>0) coordinate systems. */
     triple = dz * (dx[0]*dy[1] - dx[1]*dy[0]);
@@ -726,6 +699,26 @@ is_lefthanded(const struct grdecl *in)
 }
 
 
+/* ---------------------------------------------------------------------- */
+static int
+is_lefthanded(const struct grdecl *in)
+/* ---------------------------------------------------------------------- */
+{
+    int    found;
+    size_t c;
+    double dz;
+
+    found = find_vertical_size(in, &c, &dz);
+
+    assert (found);       /* active && (fabs(dz) > 0) */
+#if defined(NDEBUG)
+    (void) found;
+#endif
+
+    return is_lefthanded_dz(in, dz);
+}
+
+
 /* ---------------------------------------------------------------------- */
 static void
 reverse_face_nodes(struct processed_grid *out)
@@ -752,31 +745,365 @@ reverse_face_nodes(struct processed_grid *out)
 
 
 /*-----------------------------------------------------------------
-  Public interface
+  Face processing.
+
+  Faces are generated in two passes.  The first pass counts the faces,
+  face nodes, intersections and active cells of every block of
+  consecutive pillar/cell rows in each of the three sweeps
+  (constant-i, constant-j and horizontal faces).  The output arrays
+  are then allocated once, at their exact final size, and the second
+  pass lets each block resume the sweep at its own (known) position in
+  those arrays.  Blocks are independent and may be processed on
+  separate threads, and the result is the same for any number of
+  blocks.
 */
-void process_grdecl(const struct grdecl   *in,
-                    double                tolerance,
-                    struct processed_grid *out)
+struct face_block {
+    int phase;                  /* 0, 1: vertical, 2: horizontal */
+    int jstart, jend;
+
+    int        nfaces, nintersections, ncells;
+    face_pos_t nfacenodes;
+
+    /* Position of block's first entity in the output arrays. */
+    int        face0, intersection0, cell0;
+    face_pos_t facenode0;
+};
+
+
+/* Number of faces, face nodes and intersections in each sweep. */
+struct face_counts {
+    int        nfaces[3], nintersections[3];
+    face_pos_t nfacenodes[3];
+};
+
+
+/* ---------------------------------------------------------------------- */
+static int
+num_face_blocks(int ny)
+/* ---------------------------------------------------------------------- */
+{
+    int nblocks = 1;
+
+#ifdef _OPENMP
+    /* A few blocks per thread to even out the load across faulted
+     * and unfaulted regions. */
+    if (omp_get_max_threads() > 1) {
+        nblocks = 4 * omp_get_max_threads();
+    }
+#endif
+
+    return MAX(MIN(nblocks, ny), 1);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int *
+alloc_work(int nz)
+/* ---------------------------------------------------------------------- */
+{
+    int  i;
+    int *work = malloc(2 * ((size_t) (2*nz + 2)) * sizeof *work);
+
+    if (work == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "alloc_work()\n");
+        exit(1);
+    }
+    for (i = 0; i < 4 * (nz + 1); ++i) { work[i] = -1; }
+
+    return work;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+count_vertical_faces(const struct processed_grid *out,
+                     int *plist, struct face_block *blk)
+/* ---------------------------------------------------------------------- */
+{
+    int    i, j, r;
+    int    d[3];
+    int   *cornerpts[4];
+    int   *work, *isect;
+    struct processed_grid scratch;
+
+    const int direction = blk->phase;
+    const int nx        = out->dimensions[0];
+    const int nz        = out->dimensions[2];
+
+    /* The connections of a single pillar pair are generated into
+     * scratch storage.  It must be able to manage the (pathological)
+     * case of every single cell on one side of a fault connecting to
+     * all cells on the other side of the fault (i.e., an all-to-all
+     * cell connectivity pairing). */
+    r = (2*nz + 2) * (2*nz + 2);
+
+    scratch.face_nodes     = malloc(6 * ((size_t) r) * sizeof *scratch.face_nodes);
+    scratch.face_ptr       = malloc((  (size_t) r + 1) * sizeof *scratch.face_ptr);
+    scratch.face_neighbors = malloc(2 * ((size_t) r) * sizeof *scratch.face_neighbors);
+    isect                  = malloc(4 * ((size_t) r) * sizeof *isect);
+
+    if ((scratch.face_nodes     == NULL) || (scratch.face_ptr == NULL) ||
+        (scratch.face_neighbors == NULL) || (isect            == NULL)) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "count_vertical_faces()\n");
+        exit(1);
+    }
+
+    scratch.number_of_nodes_on_pillars = out->number_of_nodes_on_pillars;
+    scratch.face_ptr[0] = 0;
+
+    work = alloc_work(nz);
+
+    d[0] = 2 * (nx + 0);
+    d[1] = 2 * (out->dimensions[1] + 0);
+    d[2] = 2 * (nz + 1);
+
+    for (j = blk->jstart; j < blk->jend; ++j) {
+        for (i = 0; i < nx + (1 - direction); ++i) {
+
+            get_pillar_pair(direction, i, j, d, plist, cornerpts);
+
+            scratch.number_of_faces = 0;
+            scratch.number_of_nodes = scratch.number_of_nodes_on_pillars;
+
+            findconnections(2*nz + 2, cornerpts, isect, work, &scratch);
+
+            blk->nfaces         += scratch.number_of_faces;
+            blk->nfacenodes     += scratch.face_ptr[scratch.number_of_faces];
+            blk->nintersections += scratch.number_of_nodes -
+                scratch.number_of_nodes_on_pillars;
+        }
+    }
+
+    free(work);
+    free(isect);
+    free(scratch.face_neighbors);
+    free(scratch.face_ptr);
+    free(scratch.face_nodes);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+count_horizontal_faces(const struct processed_grid *out,
+                       int *plist, struct face_block *blk)
+/* ---------------------------------------------------------------------- */
+{
+    int i, j, k, open;
+    int d[3];
+    int *c[4];
+
+    /* dimensions of plist */
+    d[0] = 2*out->dimensions[0];
+    d[1] = 2*out->dimensions[1];
+    d[2] = 2+2*out->dimensions[2];
+
+    /* Mirrors the face generation of process_horizontal_faces(). */
+    for (j = blk->jstart; j < blk->jend; ++j) {
+        for (i = 0; i < out->dimensions[0]; ++i) {
+
+            igetvectors(d, 2*i+1, 2*j+1, plist, c);
+
+            open = 0;
+            for (k = 1; k < d[2] - 1; ++k) {
+                if (c[0][k] == c[0][k+1] && c[1][k] == c[1][k+1] &&
+                    c[2][k] == c[2][k+1] && c[3][k] == c[3][k+1]) {
+                    continue;
+                }
+
+                if (k % 2) {
+                    blk->nfaces += 1;
+                    blk->ncells += 1;
+                    open         = 1;
+                }
+                else if (open) {
+                    blk->nfaces += 1;
+                    open         = 0;
+                }
+            }
+        }
+    }
+
+    blk->nfacenodes = 4 * (face_pos_t) blk->nfaces;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+fill_face_block(const struct processed_grid *out, int b,
+                int *intersections, int *plist,
+                const struct face_block *blk)
+/* ---------------------------------------------------------------------- */
+{
+    int   *work;
+    struct processed_grid part;
+
+    /* View of the output arrays in which the sweep resumes at the
+     * block's first face, node and cell.  Each block's face_ptr is
+     * displaced by one entry per preceding block to keep the blocks'
+     * face_ptr[0] entries apart. */
+    part                  = *out;
+    part.face_ptr         = out->face_ptr + b;
+    part.number_of_faces  = blk->face0;
+    part.number_of_nodes  = out->number_of_nodes_on_pillars + blk->intersection0;
+    part.number_of_cells  = blk->cell0;
+
+    part.face_ptr[part.number_of_faces] = blk->facenode0;
+
+    if (blk->phase < 2) {
+        work = alloc_work(out->dimensions[2]);
+
+        process_vertical_faces(blk->phase, blk->jstart, blk->jend,
+                               intersections, plist, work, &part);
+        free(work);
+    } else {
+        process_horizontal_faces(blk->jstart, blk->jend, plist, &part);
+    }
+
+    assert (part.number_of_faces == blk->face0 + blk->nfaces);
+    assert (part.number_of_nodes == out->number_of_nodes_on_pillars +
+            blk->intersection0 + blk->nintersections);
+}
+
+
+/* ---------------------------------------------------------------------- */
+static void
+process_faces(int nblocks, const int rows[3][2],
+              struct face_counts *counts, int **intersections,
+              int *plist, struct processed_grid *out)
+/* ---------------------------------------------------------------------- */
+{
+    /* Sweep "phase" covers pillar/cell rows [rows[phase][0],
+     * rows[phase][1]). */
+    int    phase, b, nrows, nblk;
+    int    nf, nint, ncell;
+    face_pos_t nfn;
+    void  *p;
+    struct face_block *blk;
+
+    nblk = 3 * nblocks;
+    blk  = calloc(nblk, sizeof *blk);
+    if (blk == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_faces()\n");
+        exit(1);
+    }
+
+    for (phase = 0; phase < 3; phase++) {
+        nrows = rows[phase][1] - rows[phase][0];
+
+        for (b = 0; b < nblocks; b++) {
+            blk[phase*nblocks + b].phase  = phase;
+            blk[phase*nblocks + b].jstart = rows[phase][0] +
+                (int) (((size_t) b + 0) * nrows / nblocks);
+            blk[phase*nblocks + b].jend   = rows[phase][0] +
+                (int) (((size_t) b + 1) * nrows / nblocks);
+        }
+    }
+
+    /* Pass 1: Count entities in each block. */
+#pragma omp parallel for schedule(dynamic)
+    for (b = 0; b < nblk; b++) {
+        if (blk[b].phase < 2) {
+            count_vertical_faces  (out, plist, &blk[b]);
+        } else {
+            count_horizontal_faces(out, plist, &blk[b]);
+        }
+    }
+
+    memset(counts, 0, sizeof *counts);
+
+    nf = nfn = nint = ncell = 0;
+    for (b = 0; b < nblk; b++) {
+        counts->nfaces        [blk[b].phase] += blk[b].nfaces;
+        counts->nfacenodes    [blk[b].phase] += blk[b].nfacenodes;
+        counts->nintersections[blk[b].phase] += blk[b].nintersections;
+
+        blk[b].face0         = nf;
+        blk[b].facenode0     = nfn;
+        blk[b].intersection0 = nint;
+        blk[b].cell0         = ncell;
+
+        nf    += blk[b].nfaces;
+        nfn   += blk[b].nfacenodes;
+        nint  += blk[b].nintersections;
+        ncell += blk[b].ncells;
+    }
+
+    /* Allocate output at final size.  face_ptr holds one extra entry
+     * per block until the blocks have been filled. */
+    out->m              = nf;
+    out->n              = nfn;
+    out->face_neighbors = malloc(2 * MAX(nf  , 1) * sizeof *out->face_neighbors);
+    out->face_nodes     = malloc(    MAX(nfn , 1) * sizeof *out->face_nodes);
+    out->face_ptr       = malloc(   (nf + nblk)   * sizeof *out->face_ptr);
+    out->face_tag       = malloc(    MAX(nf  , 1) * sizeof *out->face_tag);
+    *intersections      = malloc(4 * MAX(nint, 1) * sizeof **intersections);
+
+    if ((out->face_neighbors == NULL) || (out->face_nodes == NULL) ||
+        (out->face_ptr       == NULL) || (out->face_tag   == NULL) ||
+        (*intersections      == NULL)) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_faces()\n");
+        exit(1);
+    }
+
+    /* Pass 2: Generate faces directly into output arrays. */
+#pragma omp parallel for schedule(dynamic)
+    for (b = 0; b < nblk; b++) {
+        fill_face_block(out, b, *intersections, plist, &blk[b]);
+    }
+
+    /* Close the gaps between the blocks' face_ptr ranges. */
+    for (b = 1; b < nblk; b++) {
+        memmove(out->face_ptr + blk[b].face0 + 1,
+                out->face_ptr + blk[b].face0 + b + 1,
+                blk[b].nfaces * sizeof *out->face_ptr);
+    }
+    p = realloc(out->face_ptr, (nf + 1) * sizeof *out->face_ptr);
+    if (p != NULL) { out->face_ptr = p; }
+
+    out->number_of_faces = nf;
+    out->number_of_nodes = out->number_of_nodes_on_pillars + nint;
+    out->number_of_cells = ncell;
+
+    free(blk);
+}
+
+
+/*-----------------------------------------------------------------
+  Process cell rows "rows" of "in" with known ZCORN sign and
+  handedness.  Faces of sweep "phase" are generated for pillar/cell
+  rows [rows[phase][0], rows[phase][1]), and local_cell_index is
+  defined for the cell rows of the horizontal sweep.  Face neighbours
+  are left as global (uncompressed) Cartesian cell indices.
+*/
+static void
+process_cell_rows(const struct grdecl   *in,
+                  double                 tolerance,
+                  int                    sign,
+                  int                    left_handed,
+                  const int              rows[3][2],
+                  struct face_counts    *counts,
+                  int                   *pillar_ptr,
+                  struct processed_grid *out)
 {
     struct grdecl g;
 
     size_t i;
-    int    sign, error, left_handed;
-    int    cellnum;
+    int    nblocks;
 
-    int    *actnum, *iptr;
-    int    *global_cell_index;
+    int    *actnum;
 
     double *zcorn;
 
-    const size_t BIGNUM = 64;
     const int    nx = in->dims[0];
     const int    ny = in->dims[1];
     const int    nz = in->dims[2];
     const size_t nc = ((size_t) nx) * ((size_t) ny) * ((size_t) nz);
 
     /* internal work arrays */
-    int    *work;
     int    *plist;
     int    *intersections;
 
@@ -785,22 +1112,18 @@ void process_grdecl(const struct grdecl   *in,
 
     /* -----------------------------------------------------------------*/
     /* Initialize output structure:
-       1) allocate space for grid topology (which may need to be
-          increased)
-       2) set Cartesian imensions
+       1) set Cartesian imensions (face topology is allocated once the
+          number of faces is known)
     */
-    out->m                = (int) (BIGNUM / 3);
-    out->n                = (int) BIGNUM;
-
-    out->face_neighbors   = malloc( BIGNUM      * sizeof *out->face_neighbors);
-    out->face_nodes       = malloc( out->n      * sizeof *out->face_nodes);
-    out->face_ptr         = malloc((out->m + 1) * sizeof *out->face_ptr);
-    out->face_tag         = malloc( out->m      * sizeof *out->face_tag);
-    out->face_ptr[0]      = 0;
-
     out->dimensions[0]    = in->dims[0];
     out->dimensions[1]    = in->dims[1];
     out->dimensions[2]    = in->dims[2];
+    out->m                = 0;
+    out->n                = 0;
+    out->face_neighbors   = NULL;
+    out->face_nodes       = NULL;
+    out->face_ptr         = NULL;
+    out->face_tag         = NULL;
     out->number_of_faces  = 0;
     out->number_of_nodes  = 0;
     out->number_of_cells  = 0;
@@ -829,7 +1152,6 @@ void process_grdecl(const struct grdecl   *in,
     g.actnum  = copy_and_permute_actnum(nx, ny, nz, in->actnum, actnum);
 
     zcorn     = malloc (nc * 8 * sizeof *zcorn);
-    sign      = get_zcorn_sign(nx, ny, nz, in->actnum, in->zcorn, &error);
     g.zcorn   = copy_and_permute_zcorn(nx, ny, nz, in->zcorn, sign, zcorn);
 
     g.coord   = in->coord;
@@ -839,13 +1161,11 @@ void process_grdecl(const struct grdecl   *in,
      * padding */
     plist = malloc(8 * (nc + ((size_t)nx)*((size_t)ny)) * sizeof *plist);
 
-    finduniquepoints(&g, plist, tolerance, out);
+    finduniquepoints(&g, plist, tolerance, pillar_ptr, out);
 
     free (zcorn);
     free (actnum);
 
-    /* Determine if coordinate system is left handed or not. */
-    left_handed = is_lefthanded(in);
     if (left_handed) {
         /* Reflect Y coordinates about XZ plane to create right-handed
          * coordinate system whilst processing intersections. */
@@ -857,21 +1177,10 @@ void process_grdecl(const struct grdecl   *in,
     /* -----------------------------------------------------------------*/
     /* Find face topology and face-to-cell connections */
 
-    /* internal */
-    work = malloc(2 * ((size_t) (2*nz + 2)) * sizeof *work);
-    for(i = 0; i < ((size_t)4) * (nz + 1); ++i) { work[i] = -1; }
-
-    /* internal array to store intersections */
-    intersections = malloc(BIGNUM* sizeof(*intersections));
-
-
-
-    process_vertical_faces   (0, &intersections, plist, work, out);
-    process_vertical_faces   (1, &intersections, plist, work, out);
-    process_horizontal_faces (   &intersections, plist,       out);
+    nblocks = num_face_blocks(rows[0][1] - rows[0][0]);
+    process_faces(nblocks, rows, counts, &intersections, plist, out);
 
     free (plist);
-    free (work);
 
     /* -----------------------------------------------------------------*/
     /* (re)allocate space for and compute coordinates of nodes that
@@ -880,12 +1189,51 @@ void process_grdecl(const struct grdecl   *in,
 
     free (intersections);
 
-    /* -----------------------------------------------------------------*/
-    /* Enumerate compressed cells:
-       -make array [0...#cells-1] of global cell numbers
-       -make [0...nx*ny*nz-1] array of local cell numbers,
-       lexicographically ordered, used to remap out->face_neighbors
-    */
+    /* Reflect Y coordinate back to original position if left-handed
+     * coordinate system was detected and handled earlier. */
+    if (left_handed) {
+        for (i = 1; i < ((size_t) 3) * out->number_of_nodes; i += 3) {
+            out->node_coordinates[i] = -out->node_coordinates[i];
+        }
+    }
+
+    /* if sign==-1 in ZCORN preprocessing, the sign of the
+     * z-coordinate need to change before we finish */
+    if (sign == -1)
+    {
+        for (i = 2; i < ((size_t) 3) * out->number_of_nodes; i += 3)
+            out->node_coordinates[i] *= sign;
+    }
+
+    /* If an odd number of coordinate reflections were applied, the
+     * processing routines--especially facetopology()--will produce
+     * node orderings that lead to normals pointing from 2 to 1.
+     * Reverse nodes to reestablish expected normal direction (and
+     * positive cell volumes). */
+    if (left_handed ^ (sign == -1)) {
+        reverse_face_nodes(out);
+    }
+}
+
+
+/*-----------------------------------------------------------------
+  Enumerate compressed cells:
+  -make array [0...#cells-1] of global cell numbers
+  -make [0...nx*ny*nz-1] array of local cell numbers,
+  lexicographically ordered, used to remap out->face_neighbors
+*/
+static void
+compress_cells(struct processed_grid *out)
+{
+    size_t i;
+    int    cellnum;
+    int    *iptr;
+    int    *global_cell_index;
+
+    const size_t nc = ((size_t) out->dimensions[0]) *
+                      ((size_t) out->dimensions[1]) *
+                      ((size_t) out->dimensions[2]);
+
     global_cell_index = malloc(nc * sizeof *global_cell_index);
     cellnum = 0;
     for (i = 0; i < nc; ++i) {
@@ -907,33 +1255,593 @@ void process_grdecl(const struct grdecl   *in,
 
     free(out->local_cell_index);
     out->local_cell_index = global_cell_index;
+}
 
-    /* Reflect Y coordinate back to original position if left-handed
-     * coordinate system was detected and handled earlier. */
-    if (left_handed) {
-        for (i = 1; i < ((size_t) 3) * out->number_of_nodes; i += 3) {
-            out->node_coordinates[i] = -out->node_coordinates[i];
+
+/*-----------------------------------------------------------------
+  Public interface
+*/
+void process_grdecl(const struct grdecl   *in,
+                    double                tolerance,
+                    struct processed_grid *out)
+{
+    int    sign, error, left_handed;
+    int    rows[3][2];
+    struct face_counts counts;
+
+    /* All constant-i faces, constant-j faces and horizontal faces. */
+    rows[0][0] = 0;  rows[0][1] = in->dims[1];
+    rows[1][0] = 0;  rows[1][1] = in->dims[1] + 1;
+    rows[2][0] = 0;  rows[2][1] = in->dims[1];
+
+    sign        = get_zcorn_sign(in->dims[0], in->dims[1], in->dims[2],
+                                 in->actnum, in->zcorn, &error);
+
+    /* Determine if coordinate system is left handed or not. */
+    left_handed = is_lefthanded(in);
+
+    process_cell_rows(in, tolerance, sign, left_handed,
+                      rows, &counts, NULL, out);
+
+    compress_cells(out);
+}
+
+/*-----------------------------------------------------------------
+  Streaming (out-of-core) processing.
+
+  The model is processed in slabs of consecutive cell rows (j).  Each
+  slab is read along with one halo row on either side so that the
+  pillars on the slab's boundary see all their cells, processed as a
+  small grid of its own, and appended to the output file.  Pillar
+  nodes are numbered globally as the slabs are written, while
+  intersection nodes, face order and cell compression are resolved by
+  read_processed_grid() from the per-slab counts in the file header.
+
+  File layout (native byte order):
+
+    char               magic[8]
+    int                dims[3], nslabs
+    struct stream_slab slab[nslabs]
+
+  followed by, for each slab,
+
+    double  pillar node coordinates     [3*npillarnodes]
+    double  intersection coordinates    [3*(nintersections[0] +
+                                            nintersections[1])]
+    and for each sweep p = 0, 1, 2:
+      face_pos_t end of each face's nodes [nfaces[p]]
+      int   face nodes                  [nfacenodes[p]]
+      int   face neighbours             [2*nfaces[p]]
+    char    cell active flags           [nx*(j1-j0)*nz]
+
+  Face nodes are global pillar node numbers (>= 0), or -(1+k) for the
+  slab's k'th intersection node.  Face neighbours are global
+  (uncompressed) Cartesian cell indices.
+*/
+static const char stream_magic[8] = { 'P', 'G', 'S', 'T', 'R', 'E', 'A', 'M' };
+
+struct stream_slab {
+    int j0, j1;
+    int npillarnodes;
+    int nfaces[3];
+    int nfacenodes[3];
+    int nintersections[2];
+};
+
+
+/* ---------------------------------------------------------------------- */
+static int
+read_slab_rows(const struct grdecl_source *src, int j0, int j1,
+               double **zcorn, int **actnum, struct grdecl *g)
+/* ---------------------------------------------------------------------- */
+{
+    const size_t nx = src->dims[0];
+    const size_t nz = src->dims[2];
+    const size_t nc = nx * ((size_t) (j1 - j0)) * nz;
+
+    *zcorn  = malloc(8 * nc * sizeof **zcorn);
+    *actnum = malloc(    nc * sizeof **actnum);
+
+    if ((*zcorn == NULL) || (*actnum == NULL)) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "read_slab_rows()\n");
+        exit(1);
+    }
+
+    g->dims[0] = src->dims[0];
+    g->dims[1] = j1 - j0;
+    g->dims[2] = src->dims[2];
+    g->coord   = src->coord + 6*(nx + 1)*((size_t) j0);
+    g->zcorn   = *zcorn;
+    g->actnum  = *actnum;
+
+    if (! src->read_rows(src->ctx, j0, j1, *zcorn, *actnum)) {
+        fprintf(stderr, "Failed to read cell rows [%d, %d)\n", j0, j1);
+        return 0;
+    }
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+scan_slabs(const struct grdecl_source *src, int slab_rows,
+           int *sign, int *left_handed)
+/* ---------------------------------------------------------------------- */
+{
+    /* Determine ZCORN sign and handedness as in process_grdecl().
+     * This requires looking at every slab once before processing. */
+    int           ok, error, nondecr[2];
+    int           j0, j1, found;
+    size_t        c, cg, best, i, jl, k;
+    double        dz, best_dz;
+    double       *zcorn;
+    int          *actnum;
+    struct grdecl g;
+
+    const int    nx = src->dims[0];
+    const int    ny = src->dims[1];
+    const int    nz = src->dims[2];
+
+    nondecr[0] = nondecr[1] = 1;
+    best       = ((size_t) nx) * ((size_t) ny) * ((size_t) nz);
+    best_dz    = 0.0;
+
+    ok = 1;
+    for (j0 = 0; ok && (j0 < ny); j0 = j1) {
+        j1 = MIN(j0 + slab_rows, ny);
+
+        ok = read_slab_rows(src, j0, j1, &zcorn, &actnum, &g);
+
+        if (ok) {
+            nondecr[0] = nondecr[0] &&
+                zcorn_is_nondecreasing(nx, j1 - j0, nz, actnum, zcorn,  1);
+            nondecr[1] = nondecr[1] &&
+                zcorn_is_nondecreasing(nx, j1 - j0, nz, actnum, zcorn, -1);
+
+            found = find_vertical_size(&g, &c, &dz);
+            if (found) {
+                /* Slab index to global index. */
+                i  = c % nx;  c /= nx;
+                jl = c % (j1 - j0);
+                k  = c / (j1 - j0);
+                cg = i + nx*((jl + j0) + ny*k);
+
+                if (cg < best) {
+                    best    = cg;
+                    best_dz = dz;
+                }
+            }
         }
+
+        free(actnum);
+        free(zcorn);
     }
 
-    /* if sign==-1 in ZCORN preprocessing, the sign of the
-     * z-coordinate need to change before we finish */
-    if (sign == -1)
-    {
-        for (i = 2; i < ((size_t) 3) * out->number_of_nodes; i += 3)
-            out->node_coordinates[i] *= sign;
+    if (! ok) { return 0; }
+
+    for (*sign = 1; *sign > -2; *sign = *sign - 2) {
+        error = ! nondecr[(1 - *sign) / 2];
+
+        if (! error) {
+            break;
+        }
+
+        fprintf(stderr, "\nZCORN should be strictly "
+                "nondecreasing along pillars!\n");
     }
 
-    /* If an odd number of coordinate reflections were applied, the
-     * processing routines--especially facetopology()--will produce
-     * node orderings that lead to normals pointing from 2 to 1.
-     * Reverse nodes to reestablish expected normal direction (and
-     * positive cell volumes). */
-    if (left_handed ^ (sign == -1)) {
-        reverse_face_nodes(out);
+    if (error) {
+        fprintf(stderr, "Attempt to reverse sign in ZCORN failed.\n"
+                "Grid definition may be broken\n");
+    }
+
+    g.dims[0] = src->dims[0];
+    g.dims[1] = src->dims[1];
+    g.dims[2] = src->dims[2];
+    g.coord   = src->coord;
+
+    *left_handed = is_lefthanded_dz(&g, best_dz);
+
+    return 1;
+}
+
+
+/* ---------------------------------------------------------------------- */
+static int
+process_slab(const struct grdecl_source *src, double tolerance,
+             int sign, int left_handed, int pillar_offset,
+             struct stream_slab *slab, FILE *fp)
+/* ---------------------------------------------------------------------- */
+{
+    int           ok, p, ja, jb, nr, lastrow;
+    int           base, np, v, f, nint;
+    int           fstart[4], nstart[3];
+    size_t        i, jl, k, ix, nslabcells;
+    int           rows[3][2];
+    int          *pillar_ptr, *actnum;
+    double       *zcorn;
+    char         *active;
+    struct grdecl          g;
+    struct face_counts     counts;
+    struct processed_grid  part;
+
+    const size_t nx = src->dims[0];
+    const size_t ny = src->dims[1];
+    const size_t nz = src->dims[2];
+
+    /* Slab with one halo row on either side. */
+    ja      = MAX(slab->j0 - 1, 0);
+    jb      = MIN(slab->j1 + 1, (int) ny);
+    nr      = jb - ja;
+    lastrow = slab->j1 == (int) ny;
+
+    ok = read_slab_rows(src, ja, jb, &zcorn, &actnum, &g);
+    if (! ok) {
+        free(actnum);
+        free(zcorn);
+        return 0;
+    }
+
+    rows[0][0] = slab->j0 - ja;  rows[0][1] = slab->j1 - ja;
+    rows[1][0] = slab->j0 - ja;  rows[1][1] = slab->j1 - ja + lastrow;
+    rows[2][0] = slab->j0 - ja;  rows[2][1] = slab->j1 - ja;
+
+    pillar_ptr = malloc(((nx + 1)*(nr + 1) + 1) * sizeof *pillar_ptr);
+    if (pillar_ptr == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_slab()\n");
+        exit(1);
+    }
+
+    process_cell_rows(&g, tolerance, sign, left_handed,
+                      rows, &counts, pillar_ptr, &part);
+
+    free(actnum);
+    free(zcorn);
+
+    /* The slab owns pillar rows [j0, j1), and the last slab also
+     * owns the final row of pillars. */
+    base = pillar_ptr[(nx + 1)*(slab->j0 - ja)];
+    np   = part.number_of_nodes_on_pillars;
+
+    slab->npillarnodes = pillar_ptr[(nx + 1)*(slab->j1 - ja + lastrow)] - base;
+    for (p = 0; p < 3; p++) {
+        slab->nfaces    [p] = counts.nfaces    [p];
+        slab->nfacenodes[p] = counts.nfacenodes[p];
+    }
+    slab->nintersections[0] = counts.nintersections[0];
+    slab->nintersections[1] = counts.nintersections[1];
+
+    free(pillar_ptr);
+
+    /* Global node numbers.  Faces only reference pillar rows [j0, j1]
+     * which are numbered consecutively from pillar_offset. */
+    for (f = 0; f < part.face_ptr[part.number_of_faces]; f++) {
+        v = part.face_nodes[f];
+
+        if (v < np) {
+            assert (v >= base);
+            part.face_nodes[f] = pillar_offset + (v - base);
+        } else {
+            part.face_nodes[f] = -(1 + (v - np));
+        }
+    }
+
+    /* Global Cartesian cell indices. */
+    for (f = 0; f < 2 * part.number_of_faces; f++) {
+        v = part.face_neighbors[f];
+
+        if (v != -1) {
+            i  = v % nx;  v /= nx;
+            jl = v % nr;
+            k  = v / nr;
+
+            part.face_neighbors[f] = (int) (i + nx*((jl + ja) + ny*k));
+        }
+    }
+
+    /* Face positions relative to start of each sweep. */
+    fstart[0] = 0;
+    for (p = 0; p < 3; p++) {
+        fstart[p + 1] = fstart[p] + counts.nfaces[p];
+    }
+    for (p = 0; p < 3; p++) {
+        nstart[p] = part.face_ptr[fstart[p]];
+    }
+    for (p = 0; p < 3; p++) {
+        for (f = fstart[p] + 1; f <= fstart[p + 1]; f++) {
+            part.face_ptr[f] -= nstart[p];
+        }
+    }
+
+    nslabcells = nx * ((size_t) (slab->j1 - slab->j0)) * nz;
+    active     = malloc(MAX(nslabcells, 1) * sizeof *active);
+    if (active == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_slab()\n");
+        exit(1);
+    }
+
+    ix = 0;
+    for (k = 0; k < nz; k++) {
+        for (jl = slab->j0 - ja; jl < (size_t) (slab->j1 - ja); jl++) {
+            for (i = 0; i < nx; i++, ix++) {
+                active[ix] = part.local_cell_index[i + nx*(jl + nr*k)] != -1;
+            }
+        }
+    }
+
+    nint = part.number_of_nodes - np;
+
+    ok = fwrite(part.node_coordinates + 3*base, sizeof(double),
+                3 * slab->npillarnodes, fp) == (size_t) (3 * slab->npillarnodes);
+    ok = ok &&
+         fwrite(part.node_coordinates + 3*np, sizeof(double),
+                3 * nint, fp) == (size_t) (3 * nint);
+
+    for (p = 0; ok && (p < 3); p++) {
+        ok = fwrite(part.face_ptr + fstart[p] + 1, sizeof *part.face_ptr,
+                    counts.nfaces[p], fp) == (size_t) counts.nfaces[p];
+        ok = ok &&
+             fwrite(part.face_nodes + nstart[p], sizeof(int),
+                    counts.nfacenodes[p], fp) == (size_t) counts.nfacenodes[p];
+        ok = ok &&
+             fwrite(part.face_neighbors + 2*fstart[p], sizeof(int),
+                    2 * counts.nfaces[p], fp) == (size_t) (2 * counts.nfaces[p]);
+    }
+
+    ok = ok && fwrite(active, sizeof *active, nslabcells, fp) == nslabcells;
+
+    if (! ok) {
+        fprintf(stderr, "Failed to write cell rows [%d, %d)\n",
+                slab->j0, slab->j1);
+    }
+
+    free(active);
+    free_processed_grid(&part);
+
+    return ok;
+}
+
+
+/*-------------------------------------------------------*/
+int process_grdecl_stream(const struct grdecl_source *src,
+                          double                      tolerance,
+                          int                         slab_rows,
+                          FILE                       *fp)
+{
+    int    ok, s, nslabs, sign, left_handed, pillar_offset;
+    long   pos;
+    struct stream_slab *slab;
+
+    const int ny = src->dims[1];
+
+    slab_rows = MAX(slab_rows, 1);
+    nslabs    = (ny + slab_rows - 1) / slab_rows;
+
+    slab = calloc(MAX(nslabs, 1), sizeof *slab);
+    if (slab == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_grdecl_stream()\n");
+        exit(1);
+    }
+
+    for (s = 0; s < nslabs; s++) {
+        slab[s].j0 = s * slab_rows;
+        slab[s].j1 = MIN(slab[s].j0 + slab_rows, ny);
     }
+
+    ok = scan_slabs(src, slab_rows, &sign, &left_handed);
+
+    /* Header is rewritten once slab sizes are known. */
+    pos = ftell(fp);
+    ok  = ok && (pos >= 0) &&
+          (fwrite(stream_magic, sizeof stream_magic, 1, fp) == 1) &&
+          (fwrite(src->dims, sizeof src->dims[0], 3, fp)    == 3) &&
+          (fwrite(&nslabs, sizeof nslabs, 1, fp)            == 1) &&
+          (fwrite(slab, sizeof *slab, nslabs, fp) == (size_t) nslabs);
+
+    pillar_offset = 0;
+    for (s = 0; ok && (s < nslabs); s++) {
+        ok = process_slab(src, tolerance, sign, left_handed,
+                          pillar_offset, &slab[s], fp);
+
+        pillar_offset += slab[s].npillarnodes;
+    }
+
+    ok = ok && (fseek(fp, pos + sizeof stream_magic +
+                      3 * sizeof src->dims[0] + sizeof nslabs,
+                      SEEK_SET) == 0);
+    ok = ok && (fwrite(slab, sizeof *slab, nslabs, fp) == (size_t) nslabs);
+    ok = ok && (fseek(fp, 0, SEEK_END) == 0);
+
+    free(slab);
+
+    return ok;
 }
 
+
+/*-------------------------------------------------------*/
+int read_processed_grid(FILE *fp, struct processed_grid *out)
+{
+    int    ok, s, p, f, v, nslabs;
+    int    npillar, nint, nfaces, ncells;
+    int    nodes[3], faces[3];
+    face_pos_t  nfacenodes, facenodes[3];
+    face_pos_t *ptr;
+    char   magic[sizeof stream_magic];
+    char  *active;
+    size_t i, k, jl, ix, nc, nslabcells;
+    struct stream_slab *slab;
+
+    const enum face_tag tag[] = { LEFT, BACK, TOP };
+
+    ok = (fread(magic, sizeof magic, 1, fp) == 1) &&
+         (memcmp(magic, stream_magic, sizeof magic) == 0) &&
+         (fread(out->dimensions, sizeof out->dimensions[0], 3, fp) == 3) &&
+         (fread(&nslabs, sizeof nslabs, 1, fp) == 1);
+
+    if (! ok) {
+        fprintf(stderr, "Not a processed grid stream\n");
+        return 0;
+    }
+
+    slab = malloc(MAX(nslabs, 1) * sizeof *slab);
+    ok   = (slab != NULL) &&
+           (fread(slab, sizeof *slab, nslabs, fp) == (size_t) nslabs);
+
+    npillar = nint = nfaces = nfacenodes = 0;
+    for (s = 0; ok && (s < nslabs); s++) {
+        npillar += slab[s].npillarnodes;
+        nint    += slab[s].nintersections[0] + slab[s].nintersections[1];
+
+        for (p = 0; p < 3; p++) {
+            nfaces     += slab[s].nfaces    [p];
+            nfacenodes += slab[s].nfacenodes[p];
+        }
+    }
+
+    nc = ((size_t) out->dimensions[0]) *
+         ((size_t) out->dimensions[1]) *
+         ((size_t) out->dimensions[2]);
+
+    out->m                = nfaces;
+    out->n                = nfacenodes;
+    out->number_of_faces  = nfaces;
+    out->number_of_nodes  = npillar + nint;
+    out->number_of_nodes_on_pillars = npillar;
+    out->face_nodes       = malloc(MAX(nfacenodes, 1) * sizeof *out->face_nodes);
+    out->face_ptr         = malloc((nfaces + 1)       * sizeof *out->face_ptr);
+    out->face_neighbors   = malloc(2 * MAX(nfaces, 1) * sizeof *out->face_neighbors);
+    out->face_tag         = malloc(MAX(nfaces, 1)     * sizeof *out->face_tag);
+    out->node_coordinates = malloc(3 * MAX(npillar + nint, 1) *
+                                   sizeof *out->node_coordinates);
+    out->local_cell_index = malloc(MAX(nc, 1) * sizeof *out->local_cell_index);
+
+    if ((out->face_nodes       == NULL) || (out->face_ptr       == NULL) ||
+        (out->face_neighbors   == NULL) || (out->face_tag       == NULL) ||
+        (out->node_coordinates == NULL) || (out->local_cell_index == NULL)) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "read_processed_grid()\n");
+        exit(1);
+    }
+
+    out->face_ptr[0] = 0;
+
+    /* Position of each sweep's first face, face node and intersection
+     * node in the output.  Faces and intersection nodes are ordered by
+     * sweep, then by slab, exactly as in process_grdecl(). */
+    faces[0] = 0;  facenodes[0] = 0;  nodes[0] = npillar;
+    for (p = 1; p < 3; p++) {
+        faces    [p] = faces    [p - 1];
+        facenodes[p] = facenodes[p - 1];
+        nodes    [p] = nodes    [p - 1];
+
+        for (s = 0; ok && (s < nslabs); s++) {
+            faces    [p] += slab[s].nfaces    [p - 1];
+            facenodes[p] += slab[s].nfacenodes[p - 1];
+            if (p < 2) {
+                nodes[p] += slab[s].nintersections[p - 1];
+            }
+        }
+    }
+
+    active = NULL;
+    npillar = 0;
+    for (s = 0; ok && (s < nslabs); s++) {
+        const int n0 = slab[s].nintersections[0];
+        const int n1 = slab[s].nintersections[1];
+
+        ok = (fread(out->node_coordinates + 3*npillar, sizeof(double),
+                    3 * slab[s].npillarnodes, fp)
+              == (size_t) (3 * slab[s].npillarnodes)) &&
+             (fread(out->node_coordinates + 3*nodes[0], sizeof(double),
+                    3 * n0, fp) == (size_t) (3 * n0)) &&
+             (fread(out->node_coordinates + 3*nodes[1], sizeof(double),
+                    3 * n1, fp) == (size_t) (3 * n1));
+
+        for (p = 0; ok && (p < 3); p++) {
+            ptr = out->face_ptr + faces[p] + 1;
+
+            ok = (fread(ptr, sizeof *ptr, slab[s].nfaces[p], fp)
+                  == (size_t) slab[s].nfaces[p]) &&
+                 (fread(out->face_nodes + facenodes[p], sizeof(int),
+                        slab[s].nfacenodes[p], fp)
+                  == (size_t) slab[s].nfacenodes[p]) &&
+                 (fread(out->face_neighbors + 2*faces[p], sizeof(int),
+                        2 * slab[s].nfaces[p], fp)
+                  == (size_t) (2 * slab[s].nfaces[p]));
+
+            for (f = 0; f < slab[s].nfaces[p]; f++) {
+                ptr[f] += facenodes[p];
+                out->face_tag[faces[p] + f] = tag[p];
+            }
+
+            for (f = 0; f < slab[s].nfacenodes[p]; f++) {
+                v = out->face_nodes[facenodes[p] + f];
+
+                if (v < 0) {
+                    v = -(v + 1);
+                    v = (v < n0) ? nodes[0] + v : nodes[1] + (v - n0);
+
+                    out->face_nodes[facenodes[p] + f] = v;
+                }
+            }
+
+            faces    [p] += slab[s].nfaces    [p];
+            facenodes[p] += slab[s].nfacenodes[p];
+        }
+
+        nodes[0] += n0;
+        nodes[1] += n1;
+        npillar  += slab[s].npillarnodes;
+
+        nslabcells = ((size_t) out->dimensions[0]) *
+                     ((size_t) (slab[s].j1 - slab[s].j0)) *
+                     ((size_t) out->dimensions[2]);
+
+        if (active == NULL) {
+            /* First slab is the largest. */
+            active = malloc(MAX(nslabcells, 1) * sizeof *active);
+        }
+        ok = ok && (active != NULL) &&
+             (fread(active, sizeof *active, nslabcells, fp) == nslabcells);
+
+        ix = 0;
+        for (k = 0; ok && (k < (size_t) out->dimensions[2]); k++) {
+            for (jl = slab[s].j0; jl < (size_t) slab[s].j1; jl++) {
+                for (i = 0; i < (size_t) out->dimensions[0]; i++, ix++) {
+                    out->local_cell_index[i + out->dimensions[0]*
+                                          (jl + out->dimensions[1]*k)] =
+                        active[ix] ? 0 : -1;
+                }
+            }
+        }
+    }
+
+    free(active);
+    free(slab);
+
+    if (! ok) {
+        fprintf(stderr, "Failed to read processed grid stream\n");
+        free_processed_grid(out);
+        return 0;
+    }
+
+    ncells = 0;
+    for (i = 0; i < nc; i++) {
+        ncells += out->local_cell_index[i] != -1;
+    }
+    out->number_of_cells = ncells;
+
+    compress_cells(out);
+
+    return 1;
+}
+
+
 /*-------------------------------------------------------*/
 void free_processed_grid(struct processed_grid *g)
 {
@@ -46,10 +46,26 @@
  * create_grid_cornerpoint().
  */
 
+#include <stddef.h>
+#include <stdio.h>
+#include "../indexwidth.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+    /**
+     * Integer type of positions in the "face_nodes" array of a
+     * processed_grid.  This is "int", unless CPGRID_64BIT_INDICES is
+     * set in indexwidth.h (configure option --enable-64bit-indices),
+     * which is needed for models with 2^31 or more face nodes.
+     */
+#if CPGRID_64BIT_INDICES
+    typedef ptrdiff_t face_pos_t;
+#else
+    typedef int face_pos_t;
+#endif
+
     /**
      * Raw corner-point specification of a particular geological model.
      */
@@ -60,6 +76,29 @@ extern "C" {
         const int    *actnum;  /**< Explicit "active" map.  May be NULL.*/
     };
 
+    /**
+     * Corner-point specification of a geological model that is read a few
+     * rows of cells at a time.  Used by process_grdecl_stream() to process
+     * models whose ZCORN array does not fit in memory.
+     */
+    struct grdecl_source {
+        int           dims[3]; /**< Cartesian box dimensions. */
+        const double *coord;   /**< Pillar end-points of entire model. */
+        void         *ctx;     /**< Passed unaltered to read_rows(). */
+
+        /**
+         * Read corner-point depths and "active" map of cell rows
+         * j0 <= j < j1.  Both arrays follow the ordering of the full ZCORN
+         * and ACTNUM arrays restricted to these rows, i.e., as if the
+         * model's second dimension were j1 - j0.  "actnum" must be filled
+         * with ones if the model has no explicit "active" map.
+         *
+         * @return Non-zero on success.
+         */
+        int (*read_rows)(void *ctx, int j0, int j1,
+                         double *zcorn, int *actnum);
+    };
+
     /**
      * Connection taxonomy.
      */
@@ -75,10 +114,11 @@ extern "C" {
      * a geological model in corner-point format.
      */
     struct processed_grid {
-        int m; /**< Upper bound on "number_of_faces".  For internal use in
-                    function process_grid()'s memory management. */
-        int n; /**< Upper bound on "number_of_nodes".  For internal use in
-                    function process_grid()'s memory management. */
+        int m; /**< Allocated size of "face_tag".  Equal to
+                    "number_of_faces" on return from process_grdecl(). */
+        face_pos_t n; /**< Allocated size of "face_nodes".  Equal to
+                    "face_ptr[number_of_faces]" on return from
+                    process_grdecl(). */
 
         int    dimensions[3];     /**< Cartesian box dimensions. */
 
@@ -86,7 +126,7 @@ extern "C" {
                                        (i.e., connections). */
         int    *face_nodes;       /**< Node (vertex) numbers of each face,
                                        stored sequentially. */
-        int    *face_ptr;         /**< Start position for each face's
+        face_pos_t *face_ptr;     /**< Start position for each face's
                                        `face_nodes'. */
         int    *face_neighbors;   /**< Global cell numbers.  Two elements per
                                        face, stored sequentially. */
@@ -116,6 +156,10 @@ extern "C" {
      * words, the result structure must point to a region of memory that is
      * typically backed by automatic or allocated (dynamic) storage duration.
      *
+     * When built with OpenMP support, pillars and faces are processed on
+     * multiple threads (controlled by OMP_NUM_THREADS).  The result does not
+     * depend on the number of threads.
+     *
      * @param[in]     g   Corner-point specification. If "actnum" is NULL, then
      *                    the specification is interpreted as if all cells are
      *                    initially active.
@@ -129,6 +173,39 @@ extern "C" {
                         double                 tol,
                         struct processed_grid *out);
 
+    /**
+     * Process a corner-point specification in slabs of consecutive cell rows
+     * and write the resulting grid to a binary stream.
+     *
+     * Only one slab (plus one row of cells on either side) of ZCORN and
+     * ACTNUM is held in memory at any time, along with the slab's topology.
+     * The source is read twice: once to determine the ZCORN sign and the
+     * handedness of the coordinate system, and once for processing.
+     *
+     * @param[in] src       Row-wise corner-point source.
+     * @param[in] tol       Absolute tolerance of node-coincidence.
+     * @param[in] slab_rows Number of cell rows (j) in each slab.
+     * @param[in] fp        Output stream, opened for binary writing.  Must
+     *                      be seekable.
+     * @return Non-zero on success.
+     */
+    int process_grdecl_stream(const struct grdecl_source *src,
+                              double                      tol,
+                              int                         slab_rows,
+                              FILE                       *fp);
+
+    /**
+     * Read grid written by process_grdecl_stream().
+     *
+     * The result is identical to that of process_grdecl() applied to the
+     * entire model, and must be released using free_processed_grid().
+     *
+     * @param[in]  fp  Input stream, opened for binary reading.
+     * @param[out] out Grid representation.
+     * @return Non-zero on success.
+     */
+    int read_processed_grid(FILE *fp, struct processed_grid *out);
+
     /**
      * Release memory resources acquired in previous grid processing using
      * function process_grdecl().
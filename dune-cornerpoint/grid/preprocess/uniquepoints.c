@@ -79,6 +79,70 @@ static int createSortedList(double *list, int n, int m,
 }
 
 
+/*-----------------------------------------------------------------
+  Create sorted list of z-values in zcorn with actnum==1 by merging
+  the m <= 4 columns.  The active values of each column are normally
+  nondecreasing already, in which case this is linear in the number of
+  points.  Falls back to createSortedList() otherwise.  */
+static int mergeSortedColumns(double *list, int n, int m,
+                              const double *z[], const int *a[])
+{
+    int    i, j, jmin, len, npts;
+    int    pos[4];
+    double zmin, prev = 0.0;
+
+    assert (m <= 4);
+
+    /* Check that each column's active values are nondecreasing, and
+     * find each column's first active point. */
+    npts = 0;
+    for (j=0; j<m; ++j){
+        pos[j] = n;
+        for (i=0; i<n; ++i){
+            if (a[j][i/2]) {
+                if ((pos[j] < n) && (z[j][i] < prev)) {
+                    return createSortedList(list, n, m, z, a);
+                }
+                if (pos[j] == n) { pos[j] = i; }
+                prev = z[j][i];
+                ++npts;
+            }
+        }
+    }
+
+    for (len=0; len<npts; ++len){
+        jmin = -1;
+        zmin = 0.0;
+        for (j=0; j<m; ++j){
+            if ((pos[j] < n) && ((jmin < 0) || (z[j][pos[j]] < zmin))) {
+                jmin = j;
+                zmin = z[j][pos[j]];
+            }
+        }
+
+        list[len] = zmin;
+
+        /* Advance to column's next active point.  Both points of an
+         * inactive cell are skipped. */
+        i = pos[jmin] + 1;
+        while ((i < n) && !a[jmin][i/2]) { i += 2 - (i % 2); }
+        pos[jmin] = i;
+    }
+
+    return npts;
+}
+
+
+/*-----------------------------------------------------------------
+  Sorting kernel used by finduniquepoints().  Define
+  UNIQUEPOINTS_QSORT to use the general qsort()-based kernel. */
+#if defined(UNIQUEPOINTS_QSORT)
+#define sortPillarPoints createSortedList
+#else
+#define sortPillarPoints mergeSortedColumns
+#endif
+
+
 /*-----------------------------------------------------------------
   Remove points less than <tolerance> apart in <list> of increasing
   doubles.  */
@@ -269,6 +333,8 @@ int finduniquepoints(const struct grdecl *g,
                      int           *plist, /* list of point numbers on
                                             * each pillar*/
                      double tolerance,
+                     int           *pillar_ptr, /* start of each
+                                                 * pillar's nodes */
                      struct processed_grid *out)
 
 {
@@ -276,7 +342,6 @@ int finduniquepoints(const struct grdecl *g,
     const int nx = out->dimensions[0];
     const int ny = out->dimensions[1];
     const int nz = out->dimensions[2];
-    const int nc = g->dims[0]*g->dims[1]*g->dims[2];
 
 
     /* zlist may need extra space temporarily due to simple boundary
@@ -290,85 +355,109 @@ int finduniquepoints(const struct grdecl *g,
 
 
 
-    int     i,j,k;
-
     int     d1[3];
-    int     len    = 0;
-    double  *zout  = zlist;
-    int     pos    = 0;
-    double *pt;
-    const double *z[4];
-    const int *a[4];
-    int *p;
-    int pix, cix;
-    int zix;
-
-    const double *coord = g->coord;
+    int     k, len;
+    int     ok = 1;
+    int     pillar, col;
+    void   *p;
+
+    const int slot = 8*nz;      /* zlist space reserved per pillar */
 
     d1[0] = 2*g->dims[0];
     d1[1] = 2*g->dims[1];
     d1[2] = 2*g->dims[2];
 
-    out->node_coordinates = malloc (3*8*nc*sizeof(*out->node_coordinates));
-
-    zptr[pos++] = zout - zlist;
-
-    pt    = out->node_coordinates;
-
-    /* Loop over pillars, find unique points on each pillar */
-    for (j=0; j < g->dims[1]+1; ++j){
-        for (i=0; i < g->dims[0]+1; ++i){
-
-            /* Get positioned pointers for actnum and zcorn data */
-            igetvectors(g->dims,   i,   j, g->actnum, a);
-            dgetvectors(d1,      2*i, 2*j, g->zcorn,  z);
-
-            len = createSortedList(     zout, d1[2], 4, z, a);
-            len = uniquify        (len, zout, tolerance);
-
-            /* Assign unique points */
-            for (k=0; k<len; ++k){
-                pt[2] = zout[k];
-                interpolate_pillar(coord, pt);
-                pt += 3;
-            }
-
-            /* Increment pointer to sparse table of unique zcorn
-             * values */
-            zout        = zout + len;
-            zptr[pos++] = zout - zlist;
+    /* Loop over pillars, find unique points on each pillar.  Each
+     * pillar is sorted in its own slot of zlist so the pillars can be
+     * processed independently.  The number of unique points on
+     * pillar number "pillar" is stored in zptr[pillar+1]. */
+#pragma omp parallel for schedule(static)
+    for (pillar = 0; pillar < npillars; ++pillar){
+        const double *z[4];
+        const int    *a[4];
+        double       *zout = zlist + ((size_t) pillar)*slot;
+        int           i    = pillar % (nx + 1);
+        int           j    = pillar / (nx + 1);
+        int           n;
+
+        /* Get positioned pointers for actnum and zcorn data */
+        igetvectors(g->dims,   i,   j, g->actnum, a);
+        dgetvectors(d1,      2*i, 2*j, g->zcorn,  z);
+
+        n = sortPillarPoints(   zout, d1[2], 4, z, a);
+        n = uniquify        (n, zout, tolerance);
+
+        zptr[pillar + 1] = n;
+    }
 
-            coord += 6;
+    /* Compact zlist into a sparse table of unique zcorn values.
+     * Pillars are moved in order, so the target never overlaps a
+     * pillar that has not yet been moved. */
+    zptr[0] = 0;
+    for (pillar = 0; pillar < npillars; ++pillar){
+        len = zptr[pillar + 1];
+        memmove(zlist + zptr[pillar], zlist + ((size_t) pillar)*slot,
+                len * sizeof *zlist);
+        zptr[pillar + 1] = zptr[pillar] + len;
+    }
+    out->number_of_nodes_on_pillars = zptr[npillars];
+    out->number_of_nodes            = zptr[npillars];
+
+    /* Release unused slot space and allocate exactly the unique
+     * points. */
+    p = realloc(zlist, MAX(zptr[npillars], 1)*sizeof *zlist);
+    if (p != NULL) { zlist = p; }
+
+    out->node_coordinates = malloc (3*MAX(zptr[npillars], 1)*
+                                    sizeof(*out->node_coordinates));
+
+    /* Assign unique points */
+#pragma omp parallel for schedule(static) private(k)
+    for (pillar = 0; pillar < npillars; ++pillar){
+        double *pt = out->node_coordinates + 3*zptr[pillar];
+
+        for (k = zptr[pillar]; k < zptr[pillar + 1]; ++k){
+            pt[2] = zlist[k];
+            interpolate_pillar(g->coord + 6*pillar, pt);
+            pt += 3;
         }
     }
-    out->number_of_nodes_on_pillars = zptr[pos-1];
-    out->number_of_nodes            = zptr[pos-1];
 
     /* Loop over all vertical sets of zcorn values, assign point
      * numbers */
-    p = plist;
-    for (j=0; j < 2*g->dims[1]; ++j){
-        for (i=0; i < 2*g->dims[0]; ++i){
-
-            /* pillar index */
-            pix = (i+1)/2 + (g->dims[0]+1)*((j+1)/2);
-
-            /* cell column position */
-            cix = g->dims[2]*((i/2) + (j/2)*g->dims[0]);
-
-            /* zcorn column position */
-            zix = 2*g->dims[2]*(i+2*g->dims[0]*j);
+#pragma omp parallel for schedule(static) reduction(&&:ok)
+    for (col = 0; col < 4*nx*ny; ++col){
+        int i = col % (2*nx);
+        int j = col / (2*nx);
+        int pix, cix, zix;
+        int *p = plist + ((size_t) col)*(2 + 2*nz);
+
+        /* pillar index */
+        pix = (i+1)/2 + (g->dims[0]+1)*((j+1)/2);
+
+        /* cell column position */
+        cix = g->dims[2]*((i/2) + (j/2)*g->dims[0]);
+
+        /* zcorn column position */
+        zix = 2*g->dims[2]*(i+2*g->dims[0]*j);
+
+        if (!assignPointNumbers(zptr[pix], zptr[pix+1], zlist,
+                                2*g->dims[2],
+                                g->zcorn  + zix, g->actnum + cix,
+                                p, tolerance)){
+            ok = 0;
+        }
+    }
 
-            if (!assignPointNumbers(zptr[pix], zptr[pix+1], zlist,
-                                    2*g->dims[2],
-                                    g->zcorn  + zix, g->actnum + cix,
-                                    p, tolerance)){
-                fprintf(stderr, "Something went wrong in assignPointNumbers");
-                return 0;
-            }
+    if (pillar_ptr != NULL) {
+        memcpy(pillar_ptr, zptr, (npillars + 1) * sizeof *pillar_ptr);
+    }
 
-            p += 2 + 2*g->dims[2];
-        }
+    if (!ok) {
+        fprintf(stderr, "Something went wrong in assignPointNumbers");
+        free(zptr);
+        free(zlist);
+        return 0;
     }
 
     free(zptr);
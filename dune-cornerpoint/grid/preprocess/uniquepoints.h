@@ -38,6 +38,8 @@
 int finduniquepoints(const struct grdecl *g,  /* input */
                      int                 *p,  /* for each z0 in zcorn, z0 = z[p0] */
                      double               t,  /* tolerance*/
+                     int        *pillar_ptr,  /* first node of each pillar
+                                               * (may be NULL) */
                      struct processed_grid *out);
 
 #endif /* OPM_UNIQUEPOINTS_HEADER */
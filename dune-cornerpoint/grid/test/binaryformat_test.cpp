@@ -0,0 +1,137 @@
+//===========================================================================
+//
+// File: binaryformat_test.cpp
+//
+// Created: Sat Oct 17 14:40:12 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <dune/grid/CpGrid.hpp>
+#include <cstdio>
+#include <fstream>
+#include <cstdlib>
+
+using namespace Dune;
+
+// Compares the cell and face geometry of two grids, through the
+// Dune interface. The grids must have identical numbering.
+bool sameGeometry(const CpGrid& g1, const CpGrid& g2)
+{
+    typedef CpGrid::LeafGridView View;
+    View v1 = g1.leafView();
+    View v2 = g2.leafView();
+    View::Codim<0>::Iterator c2 = v2.begin<0>();
+    for (View::Codim<0>::Iterator c1 = v1.begin<0>(); c1 != v1.end<0>(); ++c1, ++c2) {
+	if (c1->geometry().center() != c2->geometry().center()
+	    || c1->geometry().volume() != c2->geometry().volume()) {
+	    return false;
+	}
+	for (int corner = 0; corner < 8; ++corner) {
+	    if (c1->geometry().corner(corner) != c2->geometry().corner(corner)) {
+		return false;
+	    }
+	}
+	View::IntersectionIterator f2 = v2.ibegin(*c2);
+	for (View::IntersectionIterator f1 = v1.ibegin(*c1); f1 != v1.iend(*c1); ++f1, ++f2) {
+	    if (f1->geometry().center() != f2->geometry().center()
+		|| f1->geometry().volume() != f2->geometry().volume()
+		|| f1->centerUnitOuterNormal() != f2->centerUnitOuterNormal()
+		|| f1->boundary() != f2->boundary()
+		|| f1->boundaryId() != f2->boundaryId()) {
+		return false;
+	    }
+	}
+    }
+    return true;
+}
+
+
+// Overwrites the int at the given byte offset of a file.
+void overwriteInt(const char* filename, long offset, int value)
+{
+    std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Returns true if reading the file throws.
+bool readFails(const char* filename)
+{
+    CpGrid g;
+    try {
+	g.readBinary(filename);
+    } catch (const std::exception&) {
+	return true;
+    }
+    return false;
+}
+
+
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    array<int, 3> dims = {{ 4, 3, 2 }};
+    array<double, 3> sizes = {{ 1.0, 2.0, 0.5 }};
+    CpGrid g1;
+    g1.createCartesian(dims, sizes);
+
+    const char* filename = "binaryformat_test.bin";
+    g1.writeBinary(filename);
+    CpGrid g2;
+    g2.readBinary(filename);
+
+    // Corrupt topology must be rejected. The cell_to_face row sizes
+    // start right after the 80 byte header, followed by its entries.
+    const long c2f_sizes = 80;
+    const long c2f_entries = c2f_sizes + 4*g1.size(0);
+    overwriteInt(filename, c2f_sizes, 7);
+    bool corrupt_sizes_rejected = readFails(filename);
+    overwriteInt(filename, c2f_sizes, 6);
+    overwriteInt(filename, c2f_entries, 1000000);
+    bool corrupt_index_rejected = readFails(filename);
+    std::remove(filename);
+    if (!corrupt_sizes_rejected || !corrupt_index_rejected) {
+	return EXIT_FAILURE;
+    }
+
+    for (int codim = 0; codim <= 3; ++codim) {
+	if (g1.size(codim) != g2.size(codim)) {
+	    return EXIT_FAILURE;
+	}
+    }
+    if (g1.globalCell() != g2.globalCell()
+	|| g1.logicalCartesianSize() != g2.logicalCartesianSize()) {
+	return EXIT_FAILURE;
+    }
+    if (!sameGeometry(g1, g2)) {
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
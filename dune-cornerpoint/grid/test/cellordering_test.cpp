@@ -0,0 +1,119 @@
+//===========================================================================
+//
+// File: cellordering_test.cpp
+//
+// Created: Sat Oct 17 17:41:19 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/grid/CpGrid.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace Dune;
+
+// The largest difference between the numbers of two neighbouring cells.
+int bandwidth(const CpGrid& g)
+{
+    int bw = 0;
+    for (int c = 0; c < g.size(0); ++c) {
+	CpGrid::HalfFaceRange hfaces = g.halfFaces(c);
+	for (const cpgrid::HalfFace* hf = hfaces.begin(); hf != hfaces.end(); ++hf) {
+	    if (!hf->boundary) {
+		bw = std::max(bw, std::abs(hf->neighbour - c));
+	    }
+	}
+    }
+    return bw;
+}
+
+// Checks that a renumbered grid is the Cartesian grid cg with its cells
+// permuted as given by globalCell().
+bool samePermutedGrid(const CpGrid& g, const CpGrid& cg)
+{
+    const int num_cells = cg.size(0);
+    if (g.size(0) != num_cells || g.size(3) != cg.size(3)) {
+	return false;
+    }
+    std::vector<int> seen(num_cells, 0);
+    for (int c = 0; c < num_cells; ++c) {
+	const int gc = g.globalCell()[c];
+	if (gc < 0 || gc >= num_cells || seen[gc]++ != 0) {
+	    return false;
+	}
+	// Cells of a Cartesian grid are numbered as their global cells.
+	if (g.cellCentroid(c) != cg.cellCentroid(gc)
+	    || g.cellVolume(c) != cg.cellVolume(gc)) {
+	    return false;
+	}
+	CpGrid::HalfFaceRange hfaces = g.halfFaces(c);
+	CpGrid::HalfFaceRange chfaces = cg.halfFaces(gc);
+	if (hfaces.size() != chfaces.size()) {
+	    return false;
+	}
+	for (int i = 0; i < int(hfaces.size()); ++i) {
+	    const cpgrid::HalfFace& hf = hfaces.begin()[i];
+	    const cpgrid::HalfFace& chf = chfaces.begin()[i];
+	    if (hf.boundary != chf.boundary
+		|| (!hf.boundary && g.globalCell()[hf.neighbour] != chf.neighbour)
+		|| g.outerNormal(hf) != cg.outerNormal(chf)
+		|| g.faceCentroid(hf.face) != cg.faceCentroid(chf.face)) {
+		return false;
+	    }
+	}
+    }
+    return true;
+}
+
+
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    array<int, 3> dims = {{ 6, 5, 4 }};
+    array<double, 3> sizes = {{ 1.0, 2.0, 0.5 }};
+    CpGrid cg;
+    cg.createCartesian(dims, sizes);
+
+    CpGrid rcm;
+    rcm.setCellOrdering(CpGrid::ReverseCuthillMcKeeOrdering);
+    rcm.createCartesian(dims, sizes);
+    if (!samePermutedGrid(rcm, cg) || bandwidth(rcm) > bandwidth(cg)) {
+	return EXIT_FAILURE;
+    }
+
+    CpGrid hilbert;
+    hilbert.setCellOrdering(CpGrid::HilbertOrdering);
+    hilbert.createCartesian(dims, sizes);
+    if (!samePermutedGrid(hilbert, cg)) {
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+//===========================================================================
+//
+// File: halfface_test.cpp
+//
+// Created: Sat Oct 17 16:48:30 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dune/grid/CpGrid.hpp>
+#include <cmath>
+#include <cstdlib>
+
+using namespace Dune;
+
+// Checks that the half face table of a grid agrees with its
+// intersection iterators, and that every cell is closed.
+bool consistentHalfFaces(const CpGrid& g)
+{
+    typedef CpGrid::LeafGridView View;
+    typedef FieldVector<double, 3> Vector;
+    View v = g.leafView();
+    const View::IndexSet& iset = v.indexSet();
+    for (View::Codim<0>::Iterator c = v.begin<0>(); c != v.end<0>(); ++c) {
+	const int cell = iset.index(*c);
+	CpGrid::HalfFaceRange hfaces = g.halfFaces(cell);
+	const cpgrid::HalfFace* hf = hfaces.begin();
+	Vector sum(0.0);
+	for (View::IntersectionIterator is = v.ibegin(*c); is != v.iend(*c); ++is, ++hf) {
+	    if (hf == hfaces.end() || hf->boundary != is->boundary()) {
+		return false;
+	    }
+	    if (!hf->boundary && hf->neighbour != iset.index(*is->outside())) {
+		return false;
+	    }
+	    if (g.outerNormal(*hf) != is->centerUnitOuterNormal()
+		|| g.faceCentroid(hf->face) != is->geometry().center()
+		|| g.faceArea(hf->face) != is->geometry().volume()) {
+		return false;
+	    }
+	    Vector n = g.outerNormal(*hf);
+	    n *= g.faceArea(hf->face);
+	    sum += n;
+	}
+	if (hf != hfaces.end() || sum.two_norm() > 1e-12) {
+	    return false;
+	}
+	if (g.cellVolume(cell) != c->geometry().volume()) {
+	    return false;
+	}
+    }
+    return true;
+}
+
+
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    array<int, 3> dims = {{ 4, 3, 2 }};
+    array<double, 3> sizes = {{ 1.0, 2.0, 0.5 }};
+    CpGrid g;
+    g.createCartesian(dims, sizes);
+
+    // A Cartesian grid has 6 half faces per cell, and each interior
+    // face appears twice.
+    const int nx = dims[0], ny = dims[1], nz = dims[2];
+    const int num_interior = (nx - 1)*ny*nz + nx*(ny - 1)*nz + nx*ny*(nz - 1);
+    const int num_boundary = 2*(ny*nz + nx*nz + nx*ny);
+    int num_boundary_hf = 0, num_interior_hf = 0;
+    for (int c = 0; c < g.size(0); ++c) {
+	CpGrid::HalfFaceRange hfaces = g.halfFaces(c);
+	if (hfaces.size() != 6) {
+	    return EXIT_FAILURE;
+	}
+	for (const cpgrid::HalfFace* hf = hfaces.begin(); hf != hfaces.end(); ++hf) {
+	    if (hf->boundary) {
+		++num_boundary_hf;
+	    } else {
+		++num_interior_hf;
+	    }
+	}
+    }
+    if (num_interior_hf != 2*num_interior
+	|| num_boundary_hf != num_boundary) {
+	return EXIT_FAILURE;
+    }
+    if (!consistentHalfFaces(g)) {
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
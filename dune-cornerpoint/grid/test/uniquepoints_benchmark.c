@@ -0,0 +1,200 @@
+/*===========================================================================
+//
+// File: uniquepoints_benchmark.c
+//
+// Created: Sat Oct 17 10:12:40 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================*/
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Microbenchmark of finduniquepoints() on a synthetic faulted grid.
+
+  Usage: uniquepoints_benchmark [nx ny nz [repeats]]
+
+  Built twice: uniquepoints_benchmark uses the default (merge) kernel,
+  uniquepoints_benchmark_qsort the qsort()-based kernel.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <dune/grid/preprocess/preprocess.h>
+#include <dune/grid/preprocess/uniquepoints.h>
+
+
+/* Wall clock time in seconds.  Unlike clock(), this does not add up
+ * the CPU time of several threads. */
+static double
+wall_time(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec + 1.0e-6 * tv.tv_usec;
+}
+
+
+/* Deterministic pseudo-random numbers in [0,1). */
+static double
+uniform(unsigned long *state)
+{
+    *state = (1103515245UL * (*state) + 12345UL) % 2147483648UL;
+
+    return (double) (*state) / 2147483648.0;
+}
+
+
+/*-----------------------------------------------------------------
+  Create permuted (k running fastest) ZCORN and ACTNUM of a model with
+  vertical pillars.  Every column of cells is displaced by a random
+  fault throw, about ten percent of the cells are pinched and five
+  percent are inactive. */
+static void
+create_model(int nx, int ny, int nz, struct grdecl *g)
+{
+    int           i, j, k, c;
+    double        z, dz, displ;
+    double       *coord, *zcorn, *pt;
+    int          *actnum;
+    unsigned long state = 1;
+
+    coord  = malloc(6 * (nx + 1) * (ny + 1) * sizeof *coord);
+    zcorn  = malloc(8 * nx * ny * nz        * sizeof *zcorn);
+    actnum = malloc(    nx * ny * nz        * sizeof *actnum);
+
+    if ((coord == NULL) || (zcorn == NULL) || (actnum == NULL)) {
+        fprintf(stderr, "Could not allocate model\n");
+        exit(1);
+    }
+
+    for (j = 0; j <= ny; ++j) {
+        for (i = 0; i <= nx; ++i) {
+            pt = coord + 6*(i + (nx + 1)*j);
+            pt[0] = pt[3] = i;
+            pt[1] = pt[4] = j;
+            pt[2] = 0.0;
+            pt[5] = 2.0 * nz + 10.0;
+        }
+    }
+
+    for (j = 0; j < ny; ++j) {
+        for (i = 0; i < nx; ++i) {
+            displ = 0.5 * (int) (4 * uniform(&state));
+
+            z = displ;
+            for (k = 0; k < nz; ++k) {
+                dz = (uniform(&state) < 0.1) ? 0.0 : 0.5 + uniform(&state);
+                c  = k + nz*(i + nx*j);
+
+                actnum[c] = uniform(&state) < 0.05 ? 0 : 1;
+
+                /* Four corner columns of cell (i,j,k), each with top
+                 * and bottom depth. */
+                zcorn[(2*k + 0) + 2*nz*((2*i + 0) + 2*nx*(2*j + 0))] = z;
+                zcorn[(2*k + 1) + 2*nz*((2*i + 0) + 2*nx*(2*j + 0))] = z + dz;
+                zcorn[(2*k + 0) + 2*nz*((2*i + 1) + 2*nx*(2*j + 0))] = z;
+                zcorn[(2*k + 1) + 2*nz*((2*i + 1) + 2*nx*(2*j + 0))] = z + dz;
+                zcorn[(2*k + 0) + 2*nz*((2*i + 0) + 2*nx*(2*j + 1))] = z;
+                zcorn[(2*k + 1) + 2*nz*((2*i + 0) + 2*nx*(2*j + 1))] = z + dz;
+                zcorn[(2*k + 0) + 2*nz*((2*i + 1) + 2*nx*(2*j + 1))] = z;
+                zcorn[(2*k + 1) + 2*nz*((2*i + 1) + 2*nx*(2*j + 1))] = z + dz;
+
+                z += dz;
+            }
+        }
+    }
+
+    g->dims[0] = nx;
+    g->dims[1] = ny;
+    g->dims[2] = nz;
+    g->coord   = coord;
+    g->zcorn   = zcorn;
+    g->actnum  = actnum;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int           r, nx, ny, nz, repeats;
+    int          *plist;
+    double        secs, start;
+    struct grdecl g;
+    struct processed_grid out;
+
+    nx      = (argc > 1) ? atoi(argv[1]) : 100;
+    ny      = (argc > 2) ? atoi(argv[2]) : 100;
+    nz      = (argc > 3) ? atoi(argv[3]) : 50;
+    repeats = (argc > 4) ? atoi(argv[4]) : 5;
+
+    create_model(nx, ny, nz, &g);
+
+    plist = malloc(8 * (nx*ny*nz + nx*ny) * sizeof *plist);
+
+    out.dimensions[0] = nx;
+    out.dimensions[1] = ny;
+    out.dimensions[2] = nz;
+
+    start = wall_time();
+    for (r = 0; r < repeats; ++r) {
+        out.node_coordinates = NULL;
+
+        if (! finduniquepoints(&g, plist, 0.0, NULL, &out)) {
+            fprintf(stderr, "finduniquepoints() failed\n");
+            return 1;
+        }
+
+        free(out.node_coordinates);
+    }
+    secs = wall_time() - start;
+
+#if defined(UNIQUEPOINTS_QSORT)
+    printf("kernel: qsort\n");
+#else
+    printf("kernel: merge\n");
+#endif
+    printf("grid: %d x %d x %d, %d nodes on pillars\n",
+           nx, ny, nz, out.number_of_nodes_on_pillars);
+    printf("time: %g s per call, %g cells/s\n", secs / repeats,
+           ((double) nx) * ny * nz * repeats / secs);
+
+    free(plist);
+    free((double *) g.coord);
+    free((double *) g.zcorn);
+    free((int *)    g.actnum);
+
+    return 0;
+}
+
+/* Local Variables:    */
+/* c-basic-offset:4    */
+/* End:                */
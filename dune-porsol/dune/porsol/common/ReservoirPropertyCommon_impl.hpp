@@ -38,9 +38,10 @@
 
 
 #include <fstream>
+#include <algorithm>
 #include <boost/static_assert.hpp>
 #include <boost/array.hpp>
-#include <dune/common/EclipseGridInspector.hpp>
+#include <dune/common/EclipseGridParser.hpp>
 
 namespace Dune
 {
@@ -242,6 +243,33 @@ namespace Dune
             return kind;
         }
 
+
+
+        /// @brief
+        ///    The logical cartesian size of the grid of an input
+        ///    deck, from its SPECGRID or DIMENS keyword.  Unlike
+        ///    EclipseGridInspector, this does not need the COORD and
+        ///    ZCORN fields, which may have been released once the
+        ///    grid was built.
+        ///
+        /// @param [in] parser
+        ///    An Eclipse data parser.
+        boost::array<int, 3> logicalGridSize(const EclipseGridParser& parser)
+        {
+            boost::array<int, 3> dims = {{ 0, 0, 0 }};
+            if (parser.hasField("SPECGRID")) {
+                const SPECGRID& sgr = dynamic_cast<const SPECGRID&>(*parser.getSpecialValue("SPECGRID"));
+                std::copy(sgr.dimensions.begin(), sgr.dimensions.begin() + 3, dims.begin());
+            } else if (parser.hasField("DIMENS")) {
+                const std::vector<int>& dimens = parser.getIntegerValue("DIMENS");
+                ASSERT (dimens.size() >= 3);
+                std::copy(dimens.begin(), dimens.begin() + 3, dims.begin());
+            } else {
+                THROW("Found neither SPECGRID nor DIMENS in file. At least one is needed.");
+            }
+            return dims;
+        }
+
     } // anonymous namespace
 
 
@@ -552,8 +580,7 @@ namespace Dune
                                                                             const std::vector<int>& global_cell,
                                                                             double perm_threshold)
     {
-        EclipseGridInspector insp(parser);
-        boost::array<int, 3> dims = insp.gridSize();
+        boost::array<int, 3> dims = logicalGridSize(parser);
         int num_global_cells = dims[0]*dims[1]*dims[2];
         ASSERT (num_global_cells > 0);
 
@@ -207,6 +207,8 @@ namespace Dune
             residual_tolerance_ = param.getDefault("residual_tolerance", residual_tolerance_);
             linsolver_verbosity_ = param.getDefault("linsolver_verbosity", linsolver_verbosity_);
             linsolver_type_ = param.getDefault("linsolver_type", linsolver_type_);
+            flow_solver_.initLinearSolver(param);
+            flow_solver_.setParallelAssembly(param.getDefault("parallel_assembly", false));
 	    //flow_solver_.assembleStatic(ginterf_, res_prop_);
 	    // Initialize transport solver.
 	    transport_solver_.init(param, ginterf_, res_prop_, bcond_);
@@ -75,11 +75,25 @@ namespace Dune
 	    MESSAGE("Warning: We do not yet read legacy reservoir properties. Using defaults.");
 	    res_prop.init(grid.size(0));
 	} else if (fileformat == "eclipse") {
-	    EclipseGridParser parser(param.get<std::string>("filename"));
+	    int options = 0;
+	    if (param.getDefault<bool>("parallel_includes", false)) {
+		options |= EclipseGridParser::ParallelIncludes;
+	    }
+	    if (param.getDefault<bool>("lazy_fields", false)) {
+		options |= EclipseGridParser::LazyFields;
+	    }
+	    if (param.getDefault<bool>("single_precision_properties", false)) {
+		options |= EclipseGridParser::SinglePrecisionProperties;
+	    }
+	    EclipseGridParser parser(param.get<std::string>("filename"), options);
 	    double z_tolerance = param.getDefault<double>("z_tolerance", 0.0);
 	    bool periodic_extension = param.getDefault<bool>("periodic_extension", false);
 	    bool turn_normals = param.getDefault<bool>("turn_normals", false);
+	    grid.setGridCacheDirectory(param.getDefault<std::string>("grid_cache_dir", grid.gridCacheDirectory()));
 	    grid.processEclipseFormat(parser, z_tolerance, periodic_extension, turn_normals);
+	    // The grid is built, so the largest fields are no longer needed.
+	    parser.releaseField("COORD");
+	    parser.releaseField("ZCORN");
             double perm_threshold_md = param.getDefault("perm_threshold_md", 0.0);
 	    double perm_threshold = unit::convert::from(perm_threshold_md, prefix::milli*unit::darcy);
 	    std::string rock_list = param.getDefault<std::string>("rock_list", "no_list");
@@ -98,6 +112,12 @@ namespace Dune
             }
 	    res_prop.init(parser, grid.globalCell(), perm_threshold, rl_ptr,
                           use_j, sigma, theta);
+	    // The properties have copied the cell fields they use.
+	    const char* cell_fields[] = { "PORO", "PERMX", "PERMY", "PERMZ", "PERMXY",
+					  "PERMXZ", "PERMYX", "PERMYZ", "PERMZX", "PERMZY" };
+	    for (int i = 0; i < int(sizeof(cell_fields)/sizeof(cell_fields[0])); ++i) {
+		parser.releaseField(cell_fields[i]);
+	    }
 	} else if (fileformat == "cartesian") {
 	    array<int, 3> dims = {{ param.getDefault<int>("nx", 1),
 				    param.getDefault<int>("ny", 1),
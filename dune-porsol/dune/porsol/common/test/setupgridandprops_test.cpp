@@ -0,0 +1,103 @@
+//===========================================================================
+//
+// File: setupgridandprops_test.cpp
+//
+// Created: Sat Oct 17 16:05:41 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#define BOOST_TEST_DYN_LINK
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE SetupGridAndPropsTest
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <cstdio>
+#include "../setupGridAndProps.hpp"
+
+using namespace Dune;
+
+namespace
+{
+    // Writes a 2x1x1 corner-point grid of unit cells with
+    // cell properties to the given file.
+    void writeGrid(const std::string& filename)
+    {
+	std::ofstream file(filename.c_str());
+	file << "SPECGRID\n2 1 1 1 F /\n"
+	     << "COORD\n"
+	     << "0 0 0  0 0 1\n"
+	     << "1 0 0  1 0 1\n"
+	     << "2 0 0  2 0 1\n"
+	     << "0 1 0  0 1 1\n"
+	     << "1 1 0  1 1 1\n"
+	     << "2 1 0  2 1 1 /\n"
+	     << "ZCORN\n8*0 8*1 /\n"
+	     << "PORO\n0.2 0.3 /\n"
+	     << "PERMX\n100 200 /\n"
+	     << "PERMY\n100 200 /\n"
+	     << "PERMZ\n10 20 /\n";
+    }
+
+    void checkGridAndProps(const CpGrid& grid, const ReservoirPropertyCapillary<3>& res_prop)
+    {
+	BOOST_REQUIRE_EQUAL(grid.size(0), 2);
+	const double md = prefix::milli*unit::darcy;
+	for (int c = 0; c < 2; ++c) {
+	    const int g = grid.globalCell()[c];
+	    BOOST_CHECK_CLOSE(res_prop.porosity(c), g == 0 ? 0.2 : 0.3, 1e-6);
+	    BOOST_CHECK_CLOSE(res_prop.permeability(c)(0, 0), (g == 0 ? 100.0 : 200.0)*md, 1e-6);
+	    BOOST_CHECK_CLOSE(res_prop.permeability(c)(2, 2), (g == 0 ? 10.0 : 20.0)*md, 1e-6);
+	}
+    }
+}
+
+BOOST_AUTO_TEST_CASE(eclipse_file)
+{
+    const std::string filename = "setupgridandprops_test.grdecl";
+    writeGrid(filename);
+    parameter::ParameterGroup param;
+    param.insertParameter("fileformat", "eclipse");
+    param.insertParameter("filename", filename);
+    param.insertParameter("use_jfunction_scaling", "false");
+    CpGrid grid;
+    ReservoirPropertyCapillary<3> res_prop;
+    BOOST_CHECK_NO_THROW(setupGridAndProps(param, grid, res_prop));
+    checkGridAndProps(grid, res_prop);
+
+    // The parser options must not change the result.
+    param.insertParameter("lazy_fields", "true");
+    param.insertParameter("single_precision_properties", "true");
+    CpGrid grid2;
+    ReservoirPropertyCapillary<3> res_prop2;
+    BOOST_CHECK_NO_THROW(setupGridAndProps(param, grid2, res_prop2));
+    checkGridAndProps(grid2, res_prop2);
+    std::remove(filename.c_str());
+}
@@ -41,21 +41,28 @@
 #endif
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <numeric>
+#include <iostream>
 #include <ostream>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include <tr1/unordered_map>
 
 #include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/mpl/bool.hpp>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/common/ErrorMacros.hpp>
 #include <dune/common/SparseTable.hpp>
+#include <dune/common/StopWatch.hpp>
+#include <dune/common/param/ParameterGroup.hpp>
 
 #include <dune/istl/bvector.hh>
 #include <dune/istl/bcrsmatrix.hh>
@@ -436,6 +443,51 @@ namespace Dune {
         };
 
     public:
+        /// @brief
+        ///    Default constructor.  The linear solvers use the
+        ///    default settings described in @code initLinearSolver()
+        ///    @endcode.  In particular, the AMG preconditioner is
+        ///    rebuilt for every call to @code solve() @endcode.
+        IncompFlowSolverHybrid()
+            : parallel_assembly_(false),
+              amg_coupling_(FirstDiagonalCoupling),
+              amg_symmetric_(true),
+              amg_smoother_(ILU0Smoother),
+              amg_smoother_iterations_(1),
+              amg_relaxation_(1.0),
+              amg_anisotropic_(false),
+              amg_max_levels_(0),
+              amg_coarsen_target_(0),
+              amg_min_coarsen_rate_(0.0),
+              krylov_(DefaultKrylov),
+              krylov_restart_(30),
+              krylov_max_iterations_(0),
+              amg_reuse_(false),
+              amg_max_reuse_(0),
+              amg_max_iteration_growth_(2.0)
+        {
+            clear();
+        }
+
+
+        /// @brief
+        ///    Select multithreaded assembly of the system of linear
+        ///    equations.  The cells are coloured such that no two
+        ///    cells of a colour share a face, and the cells of each
+        ///    colour are assembled in parallel using OpenMP.  This
+        ///    requires an inner product with scalar mobility, such
+        ///    as @code MimeticIPEvaluator @endcode, otherwise the
+        ///    assembly remains serial.
+        ///
+        /// @param [in] parallel
+        ///    Whether or not to assemble in parallel.  Serial by
+        ///    default.
+        void setParallelAssembly(bool parallel)
+        {
+            parallel_assembly_ = parallel;
+        }
+
+
         /// @brief
         ///    All-in-one initialization routine.  Enumerates all grid
         ///    connections, allocates sufficient space, defines the
@@ -499,7 +551,28 @@ namespace Dune {
             std::vector<Scalar>().swap(g_);
             F_.clear();
 
+            std::vector<Scalar>().swap(static_L_);
+            static_F_.clear();
+            static_S_.clear();
+            static_pos_.clear();
+
+            std::vector<typename GridInterface::CellIterator>().swap(coloured_cells_);
+            std::vector<int>().swap(colour_start_);
+            assembly_time_ = 0.0;
+
             flowSolution_.clear();
+            std::vector<FlowSolution>().swap(multiSolution_);
+
+            amg_precond_.reset();
+            amg_op_.reset();
+            amg_num_reused_       = 0;
+            amg_setup_iterations_ = 0;
+            amg_rebuild_          = true;
+
+            linsolve_count_       = 0;
+            linsolve_iterations_  = 0;
+            linsolve_setup_time_  = 0.0;
+            linsolve_solve_time_  = 0.0;
 
             cleared_state_ = true;
         }
@@ -564,6 +637,149 @@ namespace Dune {
             for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c, ++i) {
                 ip_.buildStaticContrib(c, r, grav, cf.rowSize(i));
             }
+
+            computeStaticCellContribs(ScalarMobility());
+        }
+
+
+        /// @brief
+        ///    Configure the linear solvers from parameters.  All
+        ///    parameters are optional, and default to the settings
+        ///    used before this method was called.
+        ///
+        ///    The AMG preconditioner (linsolver_type 1) is controlled
+        ///    by
+        ///      - linsolver_coupling: first_diagonal or row_sum
+        ///      - linsolver_criterion: symmetric or unsymmetric
+        ///      - linsolver_smoother: ilu0 or ssor (the default
+        ///        with linsolver_reuse_precond)
+        ///      - linsolver_smoother_iterations, linsolver_relaxation
+        ///      - linsolver_anisotropic_3d: aggregation for 3D
+        ///        anisotropic problems, as suggested for SPE10
+        ///      - linsolver_max_levels, linsolver_coarsen_target,
+        ///        linsolver_min_coarsen_rate: coarsening limits,
+        ///        zero means the AMG defaults
+        ///      - linsolver_reuse_precond, linsolver_max_precond_reuse,
+        ///        linsolver_max_iteration_growth: see @code
+        ///        setPreconditionerReuse() @endcode.
+        ///
+        ///    The Krylov method is chosen by linsolver_krylov, one of
+        ///    cg, bicgstab or gmres (restarted after linsolver_restart
+        ///    iterations), or default for CG with AMG and BiCGStab
+        ///    with ILU0.  The iterations are limited by
+        ///    linsolver_max_iterations, zero means the number of
+        ///    unknowns.
+        ///
+        /// @param [in] param
+        ///    The parameters.
+        void initLinearSolver(const parameter::ParameterGroup& param)
+        {
+            std::string coupling = param.getDefault<std::string>("linsolver_coupling",
+                                                                 amg_coupling_ == FirstDiagonalCoupling
+                                                                 ? "first_diagonal" : "row_sum");
+            if (coupling == "first_diagonal") {
+                amg_coupling_ = FirstDiagonalCoupling;
+            } else if (coupling == "row_sum") {
+                amg_coupling_ = RowSumCoupling;
+            } else {
+                THROW("Unknown linsolver_coupling: " << coupling);
+            }
+
+            std::string criterion = param.getDefault<std::string>("linsolver_criterion",
+                                                                  amg_symmetric_ ? "symmetric" : "unsymmetric");
+            if (criterion == "symmetric" || criterion == "unsymmetric") {
+                amg_symmetric_ = (criterion == "symmetric");
+            } else {
+                THROW("Unknown linsolver_criterion: " << criterion);
+            }
+
+            // Preconditioner reuse needs SSOR smoothing, so it is the
+            // default smoother then.
+            const bool reuse = param.getDefault("linsolver_reuse_precond", amg_reuse_);
+            std::string smoother = param.getDefault<std::string>("linsolver_smoother",
+                                                                 amg_smoother_ == ILU0Smoother && !reuse
+                                                                 ? "ilu0" : "ssor");
+            if (smoother == "ilu0") {
+                amg_smoother_ = ILU0Smoother;
+            } else if (smoother == "ssor") {
+                amg_smoother_ = SSORSmoother;
+            } else {
+                THROW("Unknown linsolver_smoother: " << smoother);
+            }
+            amg_smoother_iterations_ = param.getDefault("linsolver_smoother_iterations", amg_smoother_iterations_);
+            amg_relaxation_          = param.getDefault("linsolver_relaxation", amg_relaxation_);
+            amg_anisotropic_         = param.getDefault("linsolver_anisotropic_3d", amg_anisotropic_);
+            amg_max_levels_          = param.getDefault("linsolver_max_levels", amg_max_levels_);
+            amg_coarsen_target_      = param.getDefault("linsolver_coarsen_target", amg_coarsen_target_);
+            amg_min_coarsen_rate_    = param.getDefault("linsolver_min_coarsen_rate", amg_min_coarsen_rate_);
+
+            std::string krylov = param.getDefault<std::string>("linsolver_krylov", krylovName(krylov_));
+            if (krylov == "default") {
+                krylov_ = DefaultKrylov;
+            } else if (krylov == "cg") {
+                krylov_ = CGKrylov;
+            } else if (krylov == "bicgstab") {
+                krylov_ = BiCGStabKrylov;
+            } else if (krylov == "gmres") {
+                krylov_ = GMResKrylov;
+            } else {
+                THROW("Unknown linsolver_krylov: " << krylov);
+            }
+            krylov_restart_        = param.getDefault("linsolver_restart", krylov_restart_);
+            krylov_max_iterations_ = param.getDefault("linsolver_max_iterations", krylov_max_iterations_);
+
+            setPreconditionerReuse(reuse,
+                                   param.getDefault("linsolver_max_precond_reuse", amg_max_reuse_),
+                                   param.getDefault("linsolver_max_iteration_growth", amg_max_iteration_growth_));
+
+            // Settings changed, so do not reuse a preconditioner.
+            amg_rebuild_ = true;
+        }
+
+
+        /// @brief
+        ///    Control reuse of the AMG preconditioner between calls
+        ///    to @code solve() @endcode.  The structure of the system
+        ///    of linear equations does not change between calls, so
+        ///    when reusing, the aggregates and smoother setup of the
+        ///    first solve are kept and only the coarse level matrices
+        ///    (the Galerkin products) are recomputed from the new
+        ///    matrix values.  The full hierarchy is rebuilt when it is
+        ///    considered stale, or when a solve fails to converge.
+        ///
+        ///    Reuse requires the SSOR smoother, which works on the
+        ///    level matrices in place and so sees the recomputed
+        ///    values.  ILU0 smoothers would keep the factors of the
+        ///    matrices they were built for, and the AMG offers no way
+        ///    to refactor them, so reuse with ILU0 smoothing throws.
+        ///    The coarse level solver is not rebuilt either; if it is
+        ///    a direct solver, the coarse correction uses the factors
+        ///    of the old coarsest matrix until the next full rebuild.
+        ///    Without reuse, the hierarchy is released after each
+        ///    solve.
+        ///
+        /// @param [in] reuse
+        ///    Whether or not to reuse the preconditioner.
+        ///
+        /// @param [in] max_reuse
+        ///    Rebuild the full hierarchy after this many reuses.
+        ///    Zero means no limit.
+        ///
+        /// @param [in] max_iteration_growth
+        ///    Rebuild the full hierarchy if a solve needs more than
+        ///    this factor times the number of iterations of the
+        ///    first solve following the last rebuild.
+        void setPreconditionerReuse(bool   reuse,
+                                    int    max_reuse            = 0,
+                                    double max_iteration_growth = 2.0)
+        {
+            if (reuse && amg_smoother_ == ILU0Smoother) {
+                THROW("AMG preconditioner reuse needs the ssor smoother, "
+                      "since ILU0 smoothers keep the factors of the first matrix.");
+            }
+            amg_reuse_                = reuse;
+            amg_max_reuse_            = max_reuse;
+            amg_max_iteration_growth_ = max_iteration_growth;
         }
 
 
@@ -650,9 +866,72 @@ namespace Dune {
                 solveLinearSystemAMG(residual_tolerance, linsolver_verbosity);
                 break;
             }
+            releaseUnusedPreconditioner();
             computePressureAndFluxes(r, sat);
         }
 
+
+        /// @brief
+        ///    Solve a sequence of flow problems that differ only in
+        ///    their boundary conditions, such as the three pressure
+        ///    drop directions of an upscaling run.  The system matrix
+        ///    depends on the kind (Dirichlet, periodic or Neumann) of
+        ///    each boundary condition, but not on its value.  A
+        ///    problem whose conditions are of the same kinds as those
+        ///    of the first problem therefore only assembles its right
+        ///    hand side, and reuses the matrix and the preconditioner
+        ///    of the first problem.  This is the case for periodic
+        ///    and linear boundary conditions.  Other problems are
+        ///    assembled and solved in full.  Following a call to
+        ///    @code solveMultiple() @endcode, solution number @code
+        ///    i @endcode may be recovered from the @code
+        ///    getSolution(i) @endcode method.
+        ///
+        /// @param [in] bcs
+        ///    The boundary conditions of each problem.  All sets
+        ///    must have the same boundary structure (e.g. periodic
+        ///    partners) as the set passed to @code init() @endcode.
+        ///
+        /// The remaining parameters are as for @code solve()
+        /// @endcode.
+        ///
+        template<class FluidInterface>
+        void solveMultiple(const FluidInterface&                  r  ,
+                           const std::vector<double>&             sat,
+                           const std::vector<const BCInterface*>& bcs,
+                           const std::vector<double>&             src,
+                           double residual_tolerance = 1e-8,
+                           int linsolver_verbosity = 1,
+                           int linsolver_type = 1)
+        {
+            const int num_problems = bcs.size();
+            std::vector<FlowSolution>(num_problems).swap(multiSolution_);
+
+            // S_ holds the (regularized) matrix of the first problem
+            // as long as every problem solved so far shares its kinds
+            // of boundary conditions.
+            bool same_matrix = false;
+            for (int i = 0; i < num_problems; ++i) {
+                same_matrix = i > 0 && same_matrix
+                    && sameConditionKinds(*bcs[0], *bcs[i]);
+                assembleDynamic(r, sat, *bcs[i], src, !same_matrix);
+                switch (linsolver_type) {
+                case 0: // ILU0 preconditioned BiCGStab
+                    solveLinearSystem(residual_tolerance, linsolver_verbosity, same_matrix);
+                    break;
+                case 1: // AMG
+                    solveLinearSystemAMG(residual_tolerance, linsolver_verbosity, same_matrix);
+                    break;
+                }
+                if (i == 0) {
+                    same_matrix = true;
+                }
+                computePressureAndFluxes(r, sat);
+                multiSolution_[i] = flowSolution_;
+            }
+            releaseUnusedPreconditioner();
+        }
+
     private:
         /// A helper class for postProcessFluxes.
         class FaceFluxes
@@ -703,12 +982,31 @@ namespace Dune {
         /// @return
         ///    The maximum modification made to the fluxes.
         double postProcessFluxes()
+        {
+            return postProcessFluxes(flowSolution_);
+        }
+
+        /// @brief
+        ///    Postprocess the fluxes of solution number @code i
+        ///    @endcode of the last call to @code solveMultiple()
+        ///    @endcode.
+        ///
+        /// @return
+        ///    The maximum modification made to the fluxes.
+        double postProcessFluxes(int i)
+        {
+            ASSERT (0 <= i && i < int(multiSolution_.size()));
+            return postProcessFluxes(multiSolution_[i]);
+        }
+
+    private:
+        double postProcessFluxes(FlowSolution& solution)
         {
             typedef typename GridInterface::CellIterator CI;
             typedef typename CI           ::FaceIterator FI;
-            const std::vector<int>& cell     = flowSolution_.cellno_;
-            const SparseTable<int>& cf       = flowSolution_.cellFaces_;
-            SparseTable<double>& cflux = flowSolution_.outflux_;
+            const std::vector<int>& cell     = solution.cellno_;
+            const SparseTable<int>& cf       = solution.cellFaces_;
+            SparseTable<double>& cflux = solution.outflux_;
 
             FaceFluxes face_fluxes(pgrid_->numberOfFaces());
             // First pass: compute projected fluxes.
@@ -757,7 +1055,7 @@ namespace Dune {
             return face_fluxes.maxMod();
         }
 
-
+    public:
         /// @brief
         ///    Type representing the solution to the problem defined
         ///    by the parameters to @code solve() @endcode.  Always a
@@ -781,6 +1079,19 @@ namespace Dune {
             return flowSolution_;
         }
 
+        /// @brief
+        ///    Recover solution number @code i @endcode of the
+        ///    problems passed to the last call to @code
+        ///    solveMultiple() @endcode.
+        ///
+        /// @return
+        ///    The requested solution.
+        SolutionType getSolution(int i)
+        {
+            ASSERT (0 <= i && i < int(multiSolution_.size()));
+            return multiSolution_[i];
+        }
+
 
         /// @brief
         ///    Print statistics about the connections in the current
@@ -822,6 +1133,32 @@ namespace Dune {
         }
 
 
+        /// @brief
+        ///    Print the timings of the linear solves since the last
+        ///    call to @code clear() @endcode, along with the linear
+        ///    solver settings used for the last solve and the time
+        ///    spent assembling the systems.
+        ///
+        /// @tparam charT
+        ///    Character type of output stream.
+        ///
+        /// @tparam traits
+        ///    Character traits of @code charT @endcode.
+        ///
+        /// @param os
+        ///    Output stream into which the timings will be printed.
+        template<typename charT, class traits>
+        void printLinearSolverStats(std::basic_ostream<charT,traits>& os)
+        {
+            os << "IncompFlowSolverHybrid<> linear solver [" << linsolve_config_ << "]:\n"
+               << "\tNumber of solves   = " << linsolve_count_ << '\n'
+               << "\tTotal iterations   = " << linsolve_iterations_ << '\n'
+               << "\tSetup time (s)     = " << linsolve_setup_time_ << '\n'
+               << "\tSolve time (s)     = " << linsolve_solve_time_ << '\n'
+               << "\tAssembly time (s)  = " << assembly_time_ << '\n';
+        }
+
+
         /// @brief
         ///    Output current system of linear equations to permanent
         ///    storage in files.  One file for the coefficient matrix
@@ -876,6 +1213,29 @@ namespace Dune {
         std::vector<Scalar> L_, g_;
         SparseTable<Scalar> F_    ;
 
+        // ----------------------------------------------------------------
+        // Cell contributions at unit total mobility, for inner
+        // products in which the mobility is a scalar factor.  The
+        // reduced cell matrix, F and L then scale with the mobility.
+        // static_pos_ holds the position of each cell matrix entry
+        // in the value array of S_.  See computeStaticCellContribs().
+        typedef boost::mpl::bool_<InnerProduct<GridInterface, RockInterface>
+                                  ::ScalarMobility != 0> ScalarMobility;
+
+        std::vector<Scalar> static_L_;
+        SparseTable<Scalar> static_F_;
+        SparseTable<Scalar> static_S_;
+        SparseTable<int>    static_pos_;
+
+        // ----------------------------------------------------------------
+        // Multithreaded assembly.  The cells are grouped by colour,
+        // colour k being coloured_cells_[colour_start_[k] ...
+        // colour_start_[k+1]).  See computeCellColouring().
+        bool                                              parallel_assembly_;
+        std::vector<typename GridInterface::CellIterator> coloured_cells_;
+        std::vector<int>                                  colour_start_;
+        double                                            assembly_time_;
+
         // ----------------------------------------------------------------
         // Actual, assembled system of linear equations
         typedef FieldVector<Scalar, 1   > VectorBlockType;
@@ -887,9 +1247,81 @@ namespace Dune {
         bool                              matrix_structure_valid_;
         bool                              do_regularization_;
 
+        // ----------------------------------------------------------------
+        // Linear solver settings.
+        enum CouplingMetricType { FirstDiagonalCoupling, RowSumCoupling };
+        enum SmootherType       { ILU0Smoother, SSORSmoother };
+        enum KrylovType         { DefaultKrylov, CGKrylov, BiCGStabKrylov, GMResKrylov };
+
+        CouplingMetricType amg_coupling_;
+        bool               amg_symmetric_;
+        SmootherType       amg_smoother_;
+        int                amg_smoother_iterations_;
+        double             amg_relaxation_;
+        bool               amg_anisotropic_;
+        int                amg_max_levels_;
+        int                amg_coarsen_target_;
+        double             amg_min_coarsen_rate_;
+        KrylovType         krylov_;
+        int                krylov_restart_;
+        int                krylov_max_iterations_;
+
+        // ----------------------------------------------------------------
+        // AMG preconditioner for the system, kept between solves if
+        // amg_reuse_ is set.  The preconditioner type depends on the
+        // settings, so it is held through a common interface.
+        typedef BCRSMatrix <MatrixBlockType>                    SystemMatrix;
+        typedef BlockVector<VectorBlockType>                    SystemVector;
+        typedef MatrixAdapter<SystemMatrix,SystemVector,SystemVector> SystemOperator;
+
+        class AMGPreconditioner : public Preconditioner<SystemVector,SystemVector>
+        {
+        public:
+            enum { category = SolverCategory::sequential };
+            virtual ~AMGPreconditioner() {}
+            virtual void recalculateHierarchy() = 0;
+        };
+
+        template <class Smoother>
+        class AMGPreconditionerImpl : public AMGPreconditioner
+        {
+        public:
+            typedef Amg::AMG<SystemOperator,SystemVector,Smoother> AMG;
+            template <class Criterion>
+            AMGPreconditionerImpl(const SystemOperator& op,
+                                  const Criterion& criterion,
+                                  const typename AMG::SmootherArgs& smootherArgs)
+                : amg_(op, criterion, smootherArgs)
+            {
+            }
+            virtual void pre(SystemVector& x, SystemVector& b) { amg_.pre(x, b); }
+            virtual void apply(SystemVector& v, const SystemVector& d) { amg_.apply(v, d); }
+            virtual void post(SystemVector& x) { amg_.post(x); }
+            virtual void recalculateHierarchy() { amg_.recalculateHierarchy(); }
+        private:
+            AMG amg_;
+        };
+
+        boost::shared_ptr<SystemOperator>    amg_op_;
+        boost::shared_ptr<AMGPreconditioner> amg_precond_;
+        bool                                 amg_reuse_;
+        int                                  amg_max_reuse_;
+        double                               amg_max_iteration_growth_;
+        int                                  amg_num_reused_;
+        int                                  amg_setup_iterations_;
+        bool                                 amg_rebuild_;
+
+        // Linear solver timings.
+        std::string                          linsolve_config_;
+        int                                  linsolve_count_;
+        int                                  linsolve_iterations_;
+        double                               linsolve_setup_time_;
+        double                               linsolve_solve_time_;
+
         // ----------------------------------------------------------------
         // Physical quantities (derived)
         FlowSolution flowSolution_;
+        std::vector<FlowSolution> multiSolution_;
 
 
         // ----------------------------------------------------------------
@@ -1276,91 +1708,468 @@ namespace Dune {
         void assembleDynamic(const FluidInterface&      fl ,
                              const std::vector<double>& sat,
                              const BCInterface&         bc ,
-                             const std::vector<double>& src)
+                             const std::vector<double>& src,
+                             bool assemble_matrix = true)
         // ----------------------------------------------------------------
         {
-            typedef typename GridInterface::CellIterator CI;
-
-            const std::vector<int>& cell = flowSolution_.cellno_;
-            const SparseTable<int>& cf   = flowSolution_.cellFaces_;
-
-            std::vector<Scalar>   data_store(max_ncf_ * max_ncf_);
-            std::vector<Scalar>   e         (max_ncf_);
-            std::vector<Scalar>   rhs       (max_ncf_);
-            std::vector<Scalar>   gflux     (max_ncf_);
-
-            std::vector<FaceType> facetype  (max_ncf_);
-            std::vector<Scalar>   condval   (max_ncf_);
-            std::vector<int>      ppartner  (max_ncf_);
+            // If assemble_matrix is false, S_ is kept as is and only
+            // the right hand side is assembled.  This is only valid if
+            // S_ was assembled for the same fluid and saturations and
+            // boundary conditions of the same kinds, see
+            // sameConditionKinds().
+            time::StopWatch clock;
+            clock.start();
 
             // Clear residual data
-            S_   = 0.0;
+            if (assemble_matrix) {
+                S_ = 0.0;
+            }
             rhs_ = 0.0;
 
             std::fill(g_.begin(), g_.end(), Scalar(0.0));
             std::fill(L_.begin(), L_.end(), Scalar(0.0));
-            std::fill(e .begin(), e .end(), Scalar(1.0));
 
             // We will have to regularize resulting system if there
             // are no prescribed pressures (i.e., Dirichlet BC's).
-            do_regularization_ = true;
+            bool dirichlet;
+            if (parallel_assembly_) {
+                dirichlet = assembleCellsColoured(fl, sat, bc, src, assemble_matrix,
+                                                  ScalarMobility());
+            } else {
+                dirichlet = assembleCells(fl, sat, bc, src, assemble_matrix);
+            }
+            do_regularization_ = !dirichlet;
+
+            assembly_time_ += clock.secsSinceStart();
+        }
+
+
+
+        // ----------------------------------------------------------------
+        // Work arrays for assembling the contribution of a single cell.
+        struct CellWorkspace
+        {
+            explicit CellWorkspace(int max_ncf)
+                : data_store(max_ncf * max_ncf),
+                  e         (max_ncf, Scalar(1.0)),
+                  rhs       (max_ncf),
+                  gflux     (max_ncf),
+                  facetype  (max_ncf),
+                  condval   (max_ncf),
+                  ppartner  (max_ncf)
+            {
+            }
+
+            std::vector<Scalar>   data_store;
+            std::vector<Scalar>   e;
+            std::vector<Scalar>   rhs;
+            std::vector<Scalar>   gflux;
+
+            std::vector<FaceType> facetype;
+            std::vector<Scalar>   condval;
+            std::vector<int>      ppartner;
+        };
+
+
+
+        // ----------------------------------------------------------------
+        template<class FluidInterface>
+        bool assembleCells(const FluidInterface&      fl ,
+                           const std::vector<double>& sat,
+                           const BCInterface&         bc ,
+                           const std::vector<double>& src,
+                           bool assemble_matrix)
+        // ----------------------------------------------------------------
+        {
+            typedef typename GridInterface::CellIterator CI;
+
+            CellWorkspace w(max_ncf_);
+            bool dirichlet = false;
 
             // Assemble dynamic contributions for each cell
             for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
-                const int ci = c->index();
-                const int c0 = cell[ci];            ASSERT (c0 < cf.size());
-                const int nf = cf[c0].size();
+                dirichlet = assembleCell(c, fl, sat, bc, src, w, assemble_matrix,
+                                         ScalarMobility())
+                    || dirichlet;
+            }
+            return dirichlet;
+        }
 
-                setExternalContrib(c, c0, bc, src[ci], rhs,
-                                   facetype, condval, ppartner);
 
-                ip_.computeDynamicParams(c, fl, sat);
 
-                SharedFortranMatrix    S(nf, nf, &data_store[0]);
-                ip_.getInverseMatrix(c, S);
+        // ----------------------------------------------------------------
+        template<class FluidInterface>
+        bool assembleCellsColoured(const FluidInterface&      fl ,
+                                   const std::vector<double>& sat,
+                                   const BCInterface&         bc ,
+                                   const std::vector<double>& src,
+                                   bool assemble_matrix,
+                                   boost::mpl::false_)
+        // ----------------------------------------------------------------
+        {
+            // The evaluator keeps the mobility of the current cell,
+            // so the cells must be assembled one at a time.
+            return assembleCells(fl, sat, bc, src, assemble_matrix);
+        }
 
-                std::fill(gflux.begin(), gflux.end(), Scalar(0.0));
-                ip_.gravityFlux(c, gflux);
 
+
+        // ----------------------------------------------------------------
+        template<class FluidInterface>
+        bool assembleCellsColoured(const FluidInterface&      fl ,
+                                   const std::vector<double>& sat,
+                                   const BCInterface&         bc ,
+                                   const std::vector<double>& src,
+                                   bool assemble_matrix,
+                                   boost::mpl::true_)
+        // ----------------------------------------------------------------
+        {
+            if (colour_start_.empty()) {
+                computeCellColouring();
+            }
+
+            // Cells of the same colour write to disjoint rows of the
+            // system, so each colour is assembled concurrently.
+            bool dirichlet = false;
+            const int num_colours = int(colour_start_.size()) - 1;
+            for (int k = 0; k < num_colours; ++k) {
+                const int begin = colour_start_[k];
+                const int end   = colour_start_[k + 1];
+#pragma omp parallel reduction(||:dirichlet)
+                {
+                    CellWorkspace w(max_ncf_);
+#pragma omp for schedule(static)
+                    for (int i = begin; i < end; ++i) {
+                        dirichlet = assembleCell(coloured_cells_[i], fl, sat, bc, src,
+                                                 w, assemble_matrix, boost::mpl::true_())
+                            || dirichlet;
+                    }
+                }
+            }
+            return dirichlet;
+        }
+
+
+
+        // ----------------------------------------------------------------
+        void computeCellColouring()
+        // ----------------------------------------------------------------
+        {
+            // Greedy colouring such that no two cells of a colour
+            // touch the same degree of freedom.  A cell touches its
+            // faces and, through addCellContrib(), their periodic
+            // partners.
+            typedef typename GridInterface::CellIterator CI;
+
+            const std::vector<int>& cell = flowSolution_.cellno_;
+            const SparseTable<int>& cf   = flowSolution_.cellFaces_;
+            const int nc = cf.size();
+
+            std::vector<CI> cells(nc, pgrid_->cellbegin());
+            for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
+                cells[cell[c->index()]] = c;
+            }
+
+            std::vector<int> touched;
+            std::vector< std::vector<int> > dof_cells(total_num_faces_);
+            std::vector<int> colour(nc, -1);
+            std::vector<int> forbidden;
+            int num_colours = 0;
+            for (int c = 0; c < nc; ++c) {
+                touched.assign(cf[c].begin(), cf[c].end());
+                if (!ppartner_dof_.empty()) {
+                    for (int i = 0; i < cf.rowSize(c); ++i) {
+                        if (ppartner_dof_[cf[c][i]] != -1) {
+                            touched.push_back(ppartner_dof_[cf[c][i]]);
+                        }
+                    }
+                }
+
+                for (int i = 0; i < int(touched.size()); ++i) {
+                    const std::vector<int>& other = dof_cells[touched[i]];
+                    for (int j = 0; j < int(other.size()); ++j) {
+                        forbidden[colour[other[j]]] = c;
+                    }
+                }
+                int k = 0;
+                while (k < num_colours && forbidden[k] == c) {
+                    ++k;
+                }
+                if (k == num_colours) {
+                    forbidden.push_back(-1);
+                    ++num_colours;
+                }
+                colour[c] = k;
+
+                for (int i = 0; i < int(touched.size()); ++i) {
+                    dof_cells[touched[i]].push_back(c);
+                }
+            }
+
+            // Group the cells by colour.
+            std::vector<int>(num_colours + 1, 0).swap(colour_start_);
+            for (int c = 0; c < nc; ++c) {
+                ++colour_start_[colour[c] + 1];
+            }
+            std::partial_sum(colour_start_.begin(), colour_start_.end(),
+                             colour_start_.begin());
+
+            std::vector<int> pos(colour_start_.begin(), colour_start_.end() - 1);
+            std::vector<CI>(nc, pgrid_->cellbegin()).swap(coloured_cells_);
+            for (int c = 0; c < nc; ++c) {
+                coloured_cells_[pos[colour[c]]++] = cells[c];
+            }
+        }
+
+
+
+        // ----------------------------------------------------------------
+        template<class FluidInterface>
+        bool assembleCell(const typename GridInterface::CellIterator c  ,
+                          const FluidInterface&                      fl ,
+                          const std::vector<double>&                 sat,
+                          const BCInterface&                         bc ,
+                          const std::vector<double>&                 src,
+                          CellWorkspace&                             w  ,
+                          bool                                       assemble_matrix,
+                          boost::mpl::false_)
+        // ----------------------------------------------------------------
+        {
+            // General inner product, form the cell contribution from
+            // the dynamic inverse inner product.
+            const SparseTable<int>& cf = flowSolution_.cellFaces_;
+            const int ci = c->index();
+            const int c0 = flowSolution_.cellno_[ci];   ASSERT (c0 < cf.size());
+            const int nf = cf[c0].size();
+
+            const bool dirichlet =
+                setExternalContrib(c, c0, bc, src[ci], w.rhs,
+                                   w.facetype, w.condval, w.ppartner);
+
+            ip_.computeDynamicParams(c, fl, sat);
+
+            SharedFortranMatrix    S(nf, nf, &w.data_store[0]);
+            ip_.getInverseMatrix(c, S);
+
+            std::fill(w.gflux.begin(), w.gflux.end(), Scalar(0.0));
+            ip_.gravityFlux(c, w.gflux);
+
+            ImmutableFortranMatrix one(nf, 1, &w.e[0]);
+            buildCellContrib(c0, one, w.gflux, S, w.rhs);
+
+            addCellContrib(S, w.rhs, w.facetype, w.condval, w.ppartner, cf[c0],
+                           assemble_matrix);
+
+            return dirichlet;
+        }
+
+
+
+        // ----------------------------------------------------------------
+        template<class FluidInterface>
+        bool assembleCell(const typename GridInterface::CellIterator c  ,
+                          const FluidInterface&                      fl ,
+                          const std::vector<double>&                 sat,
+                          const BCInterface&                         bc ,
+                          const std::vector<double>&                 src,
+                          CellWorkspace&                             w  ,
+                          bool                                       assemble_matrix,
+                          boost::mpl::true_)
+        // ----------------------------------------------------------------
+        {
+            // Scalar mobility, scale the static cell contribution.
+            // Only const methods of the evaluator are used, so cells
+            // without common degrees of freedom may be assembled
+            // concurrently.
+            const SparseTable<int>& cf = flowSolution_.cellFaces_;
+            const int ci = c->index();
+            const int c0 = flowSolution_.cellno_[ci];   ASSERT (c0 < cf.size());
+            const int nf = cf[c0].size();
+
+            const bool dirichlet =
+                setExternalContrib(c, c0, bc, src[ci], w.rhs,
+                                   w.facetype, w.condval, w.ppartner);
+
+            Scalar totmob, mob_dens;
+            ip_.evaluateMobilities(c, fl, sat, totmob, mob_dens);
+
+            std::fill(w.gflux.begin(), w.gflux.end(), Scalar(0.0));
+            ip_.gravityFlux(c, mob_dens, w.gflux);
+
+            const Scalar* F0 = &static_F_[c0][0];
+            const Scalar* S0 = &static_S_[c0][0];
+
+            // F <- totmob*F0, L <- totmob*L0
+            std::transform(F0, F0 + nf, F_[c0].begin(),
+                           boost::bind(std::multiplies<Scalar>(), _1, totmob));
+            L_[c0]  = totmob * static_L_[c0];
+            g_[c0] -= std::accumulate(w.gflux.begin(), w.gflux.end(), Scalar(0.0));
+
+            // rhs <- v_g - rhs + g_[c]/L_[c]*F, the mobility cancels.
+            const Scalar gL = g_[c0] / static_L_[c0];
+            for (int i = 0; i < nf; ++i) {
+                w.rhs[i] = w.gflux[i] - w.rhs[i] + gL*F0[i];
+            }
+
+            bool plain = true;
+            for (int i = 0; i < nf; ++i) {
+                plain = plain && (w.facetype[i] == Internal || w.facetype[i] == Neumann);
+            }
+            if (plain) {
+                // No prescribed pressures, scale and scatter directly
+                // into the value array of S_.
+                if (assemble_matrix) {
+                    MatrixBlockType* values = &*S_[0].begin();
+                    const int* pos = &static_pos_[c0][0];
+                    for (int k = 0; k < nf*nf; ++k) {
+                        values[pos[k]][0][0] += totmob * S0[k];
+                    }
+                }
+                for (int i = 0; i < nf; ++i) {
+                    rhs_[cf[c0][i]] += w.rhs[i];
+                }
+            } else {
+                SharedFortranMatrix S(nf, nf, &w.data_store[0]);
+                std::transform(S0, S0 + nf*nf, S.data(),
+                               boost::bind(std::multiplies<Scalar>(), _1, totmob));
+                addCellContrib(S, w.rhs, w.facetype, w.condval, w.ppartner, cf[c0],
+                               assemble_matrix);
+            }
+
+            return dirichlet;
+        }
+
+
+
+        // ----------------------------------------------------------------
+        void computeStaticCellContribs(boost::mpl::false_)
+        // ----------------------------------------------------------------
+        {
+            // The mobility is not a scalar factor, so the cell
+            // contributions are formed during assembly.
+        }
+
+
+
+        // ----------------------------------------------------------------
+        void computeStaticCellContribs(boost::mpl::true_)
+        // ----------------------------------------------------------------
+        {
+            typedef typename GridInterface::CellIterator CI;
+
+            const std::vector<int>& cell = flowSolution_.cellno_;
+            const SparseTable<int>& cf   = flowSolution_.cellFaces_;
+            const int nc = cf.size();
+
+            std::vector<int> sz(nc), sz2(nc);
+            for (int c = 0; c < nc; ++c) {
+                sz [c] = cf.rowSize(c);
+                sz2[c] = sz[c] * sz[c];
+            }
+            std::vector<Scalar>(nc).swap(static_L_);
+            static_F_  .allocate(sz .begin(), sz .end());
+            static_S_  .allocate(sz2.begin(), sz2.end());
+            static_pos_.allocate(sz2.begin(), sz2.end());
+
+            // The positions are offsets from the first entry of row 0,
+            // which requires the values of S_ to be stored contiguously,
+            // row by row.  The sparsity pattern is complete at this
+            // point, so check it once here.
+            const MatrixBlockType* values = &*S_[0].begin();
+            const MatrixBlockType* last   = &*S_[S_.N() - 1].beforeEnd();
+            if (last - values != std::ptrdiff_t(S_.nonzeroes()) - 1) {
+                THROW("Values of the system matrix are not stored contiguously.");
+            }
+
+            std::vector<Scalar> e(max_ncf_, Scalar(1.0));
+            for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
+                const int c0 = cell[c->index()];
+                const int nf = cf.rowSize(c0);
+
+                SharedFortranMatrix S(nf, nf, &static_S_[c0][0]);
+                ip_.getInverseMatrix(c, Scalar(1.0), S);
+
+                // Ft <- B^{-t} * ones, L <- sum(Ft), S <- S - F'*F/L
+                SharedFortranMatrix    Ft (nf, 1, &static_F_[c0][0]);
                 ImmutableFortranMatrix one(nf, 1, &e[0]);
-                buildCellContrib(c0, one, gflux, S, rhs);
+                matMulAdd_TN(Scalar(1.0), S, one, Scalar(0.0), Ft);
+                static_L_[c0] = std::accumulate(Ft.data(), Ft.data() + nf, Scalar(0.0));
+                symmetricUpdate(-Scalar(1.0)/static_L_[c0], Ft, Scalar(1.0), S);
 
-                addCellContrib(S, rhs, facetype, condval, ppartner, cf[c0]);
+                for (int j = 0; j < nf; ++j) {
+                    for (int i = 0; i < nf; ++i) {
+                        static_pos_[c0][i + j*nf] = &S_[cf[c0][i]][cf[c0][j]] - values;
+                    }
+                }
             }
         }
 
 
 
         // ----------------------------------------------------------------
-        void solveLinearSystem(double residual_tolerance, int verbosity_level)
+        bool sameConditionKinds(const BCInterface& bc1, const BCInterface& bc2) const
+        // ----------------------------------------------------------------
+        {
+            // True if every boundary face has conditions of the same
+            // kind, and the same periodic partner, in bc1 and bc2.
+            // The system matrix does not depend on anything else.
+            typedef typename GridInterface::CellIterator CI;
+            typedef typename CI           ::FaceIterator FI;
+
+            for (CI c = pgrid_->cellbegin(); c != pgrid_->cellend(); ++c) {
+                for (FI f = c->facebegin(); f != c->faceend(); ++f) {
+                    if (!f->boundary()) {
+                        continue;
+                    }
+                    const FlowBC& cond1 = bc1.flowCond(*f);
+                    const FlowBC& cond2 = bc2.flowCond(*f);
+                    if (cond1.isDirichlet() != cond2.isDirichlet() ||
+                        cond1.isPeriodic()  != cond2.isPeriodic()) {
+                        return false;
+                    }
+                    if (cond1.isPeriodic() &&
+                        bc1.getPeriodicPartner(f->boundaryId()) !=
+                        bc2.getPeriodicPartner(f->boundaryId())) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+
+
+        // ----------------------------------------------------------------
+        void solveLinearSystem(double residual_tolerance, int verbosity_level,
+                               bool same_matrix = false)
         // ----------------------------------------------------------------
         {
             // Adapted from DuMux...
             Scalar residTol = residual_tolerance;
 
-            typedef BCRSMatrix <MatrixBlockType>        Matrix;
-            typedef BlockVector<VectorBlockType>        Vector;
-            typedef MatrixAdapter<Matrix,Vector,Vector> Adapter;
-
             // Regularize the matrix (only for pure Neumann problems...)
-            if (do_regularization_) {
+            // unless it was regularized by the previous solve.
+            if (do_regularization_ && !same_matrix) {
                 S_[0][0] *= 2;
             }
-            Adapter opS(S_);
+            SystemOperator opS(S_);
 
-            // Construct preconditioner.
-            Dune::SeqILU0<Matrix,Vector,Vector> precond(S_, 1.0);
+            time::StopWatch clock;
+            clock.start();
 
-            // Construct solver for system of linear equations.
-            Dune::BiCGSTABSolver<Vector> linsolve(opS, precond, residTol,
-                                                  S_.N(), verbosity_level);
-
-            Dune::InverseOperatorResult result;
-            soln_ = 0.0;
+            // Construct preconditioner.
+            Dune::SeqILU0<SystemMatrix,SystemVector,SystemVector> precond(S_, 1.0);
+            const double setup_time = clock.secsSinceLast();
 
             // Solve system of linear equations to recover
             // face/contact pressure values (soln_).
-            linsolve.apply(soln_, rhs_, result);
+            const KrylovType krylov = (krylov_ == DefaultKrylov) ? BiCGStabKrylov : krylov_;
+            Dune::InverseOperatorResult result;
+            solveKrylov(opS, precond, krylov, residTol, verbosity_level, result);
+            const double solve_time = clock.secsSinceLast();
+
+            reportLinearSolve("ILU0/" + krylovName(krylov), setup_time, solve_time,
+                              result, verbosity_level);
             if (!result.converged) {
                 THROW("Linear solver failed to converge in " << result.iterations << " iterations.\n"
                       << "Residual reduction achieved is " << result.reduction << '\n');
@@ -1370,77 +2179,245 @@ namespace Dune {
 
 
         // ----------------------------------------------------------------
-        void solveLinearSystemAMG(double residual_tolerance, int verbosity_level)
+        void solveLinearSystemAMG(double residual_tolerance, int verbosity_level,
+                                  bool same_matrix = false)
         // ----------------------------------------------------------------
         {
             // Adapted from upscaling.cc by Arne Rekdal, 2009
             Scalar residTol = residual_tolerance;
 
-            // Representation types for linear system.
-            typedef BCRSMatrix <MatrixBlockType>        Matrix;
-            typedef BlockVector<VectorBlockType>        Vector;
-            typedef MatrixAdapter<Matrix,Vector,Vector> Operator;
-
-            // AMG specific types.
-            // Old:   FIRST_DIAGONAL 1, SYMMETRIC 1, SMOOTHER_ILU 1, ANISOTROPIC_3D 0
-            // SPE10: FIRST_DIAGONAL 0, SYMMETRIC 1, SMOOTHER_ILU 0, ANISOTROPIC_3D 1
-#define FIRST_DIAGONAL 1
-#define SYMMETRIC 1
-#define SMOOTHER_ILU 1
-#define ANISOTROPIC_3D 0
-
-#if FIRST_DIAGONAL
-            typedef Amg::FirstDiagonal CouplingMetric;
-#else
-            typedef Amg::RowSum        CouplingMetric;
-#endif
+            // Regularize the matrix (only for pure Neumann problems...)
+            // unless it was regularized by the previous solve.
+            if (do_regularization_ && !same_matrix) {
+                S_[0][0] *= 2;
+            }
 
-#if SYMMETRIC
-            typedef Amg::SymmetricCriterion<Matrix,CouplingMetric>   CriterionBase;
-#else
-            typedef Amg::UnSymmetricCriterion<Matrix,CouplingMetric> CriterionBase;
-#endif
+            const KrylovType krylov = (krylov_ == DefaultKrylov) ? CGKrylov : krylov_;
+            // If the values of S_ are unchanged since the hierarchy
+            // was built, it can be applied without any setup at all.
+            bool shared  = same_matrix && amg_precond_;
+            bool rebuild = !shared && (amg_rebuild_ || !amg_reuse_ || !amg_precond_);
+            InverseOperatorResult result;
+            double setup_time = 0.0, solve_time = 0.0;
+            for (;;) {
+                time::StopWatch clock;
+                clock.start();
+                if (rebuild) {
+                    amg_precond_.reset();
+                    amg_op_.reset(new SystemOperator(S_));
+                    buildAMGPreconditioner(verbosity_level);
+                    amg_num_reused_ = 0;
+                } else if (!shared) {
+                    // The operator refers to S_, whose structure is
+                    // unchanged.  Keep the aggregates and recompute
+                    // the coarse level matrices only.  The SSOR
+                    // smoothers see the new values, see
+                    // setPreconditionerReuse().
+                    amg_precond_->recalculateHierarchy();
+                    ++amg_num_reused_;
+                }
+                setup_time += clock.secsSinceLast();
 
-#if SMOOTHER_ILU
-            typedef SeqILU0<Matrix,Vector,Vector>        Smoother;
-#else
-            typedef SeqSSOR<Matrix,Vector,Vector>        Smoother;
-#endif
-            typedef Amg::CoarsenCriterion<CriterionBase> Criterion;
-            typedef Amg::AMG<Operator,Vector,Smoother>   Precond;
+                // Solve system of linear equations to recover
+                // face/contact pressure values (soln_).
+                solveKrylov(*amg_op_, *amg_precond_, krylov, residTol, verbosity_level, result);
+                solve_time += clock.secsSinceLast();
+                if (result.converged || rebuild) {
+                    break;
+                }
+                // Possibly a stale hierarchy, try again with a new one.
+                rebuild = true;
+                shared  = false;
+            }
+            if (rebuild) {
+                amg_setup_iterations_ = result.iterations;
+            }
+            // Decide if the hierarchy is too stale for the next solve.
+            amg_rebuild_ = (amg_max_reuse_ > 0 && amg_num_reused_ >= amg_max_reuse_)
+                || result.iterations > amg_max_iteration_growth_ * std::max(amg_setup_iterations_, 1);
 
-            // Regularize the matrix (only for pure Neumann problems...)
-            if (do_regularization_) {
-                S_[0][0] *= 2;
+            reportLinearSolve(amgName() + (rebuild ? "" : (shared ? " (shared)" : " (reused)"))
+                              + "/" + krylovName(krylov),
+                              setup_time, solve_time, result, verbosity_level);
+            if (!result.converged) {
+                THROW("Linear solver failed to converge in " << result.iterations << " iterations.\n"
+                      << "Residual reduction achieved is " << result.reduction << '\n');
             }
-            Operator opS(S_);
+        }
 
-            // Construct preconditioner.
-            double relax = 1;
-            typename Precond::SmootherArgs smootherArgs;
-            smootherArgs.relaxationFactor = relax;
 
-            Criterion criterion;
+
+        // ----------------------------------------------------------------
+        void releaseUnusedPreconditioner()
+        // ----------------------------------------------------------------
+        {
+            // The AMG hierarchy holds the coarse level matrices and
+            // the smoothers, so do not keep it unless it will be reused.
+            if (!amg_reuse_) {
+                amg_precond_.reset();
+                amg_op_.reset();
+            }
+        }
+
+
+
+        // ----------------------------------------------------------------
+        template <class Smoother, class CriterionBase>
+        void buildAMG(int verbosity_level)
+        // ----------------------------------------------------------------
+        {
+            typedef AMGPreconditionerImpl<Smoother> Impl;
+
+            Amg::CoarsenCriterion<CriterionBase> criterion;
             criterion.setDebugLevel(verbosity_level);
-#if ANISOTROPIC_3D
-            criterion.setDefaultValuesAnisotropic(3, 2);
-#endif
-            Precond precond(opS, criterion, smootherArgs);
+            if (amg_anisotropic_) {
+                criterion.setDefaultValuesAnisotropic(3, 2);
+            }
+            if (amg_max_levels_ > 0) {
+                criterion.setMaxLevel(amg_max_levels_);
+            }
+            if (amg_coarsen_target_ > 0) {
+                criterion.setCoarsenTarget(amg_coarsen_target_);
+            }
+            if (amg_min_coarsen_rate_ > 0.0) {
+                criterion.setMinCoarsenRate(amg_min_coarsen_rate_);
+            }
 
-            // Construct solver for system of linear equations.
-            CGSolver<Vector> linsolve(opS, precond, residTol, S_.N(), verbosity_level);
+            typename Impl::AMG::SmootherArgs smootherArgs;
+            smootherArgs.iterations       = amg_smoother_iterations_;
+            smootherArgs.relaxationFactor = amg_relaxation_;
 
-            InverseOperatorResult result;
+            amg_precond_.reset(new Impl(*amg_op_, criterion, smootherArgs));
+        }
+
+
+
+        // ----------------------------------------------------------------
+        template <class CouplingMetric>
+        void buildAMGForMetric(int verbosity_level)
+        // ----------------------------------------------------------------
+        {
+            typedef SeqILU0<SystemMatrix,SystemVector,SystemVector>          ILU0;
+            typedef SeqSSOR<SystemMatrix,SystemVector,SystemVector>          SSOR;
+            typedef Amg::SymmetricCriterion  <SystemMatrix,CouplingMetric>   Symmetric;
+            typedef Amg::UnSymmetricCriterion<SystemMatrix,CouplingMetric>   UnSymmetric;
+
+            if (amg_smoother_ == ILU0Smoother) {
+                if (amg_symmetric_) {
+                    buildAMG<ILU0, Symmetric>(verbosity_level);
+                } else {
+                    buildAMG<ILU0, UnSymmetric>(verbosity_level);
+                }
+            } else {
+                if (amg_symmetric_) {
+                    buildAMG<SSOR, Symmetric>(verbosity_level);
+                } else {
+                    buildAMG<SSOR, UnSymmetric>(verbosity_level);
+                }
+            }
+        }
+
+
+
+        // ----------------------------------------------------------------
+        void buildAMGPreconditioner(int verbosity_level)
+        // ----------------------------------------------------------------
+        {
+            if (amg_coupling_ == FirstDiagonalCoupling) {
+                buildAMGForMetric<Amg::FirstDiagonal>(verbosity_level);
+            } else {
+                buildAMGForMetric<Amg::RowSum>(verbosity_level);
+            }
+        }
+
+
+
+        // ----------------------------------------------------------------
+        template <class Precond>
+        void solveKrylov(SystemOperator&        op       ,
+                         Precond&               precond  ,
+                         const KrylovType       krylov   ,
+                         const double           residTol ,
+                         const int              verbosity_level,
+                         InverseOperatorResult& result)
+        // ----------------------------------------------------------------
+        {
+            const int maxit = (krylov_max_iterations_ > 0) ? krylov_max_iterations_ : int(S_.N());
+
+            // The solvers overwrite their right hand side, so give
+            // them a copy.
+            SystemVector b(rhs_);
             soln_ = 0.0;
+            switch (krylov) {
+            case CGKrylov: {
+                CGSolver<SystemVector> linsolve(op, precond, residTol, maxit, verbosity_level);
+                linsolve.apply(soln_, b, result);
+                break;
+            }
+            case BiCGStabKrylov: {
+                BiCGSTABSolver<SystemVector> linsolve(op, precond, residTol, maxit, verbosity_level);
+                linsolve.apply(soln_, b, result);
+                break;
+            }
+            case GMResKrylov: {
+                RestartedGMResSolver<SystemVector> linsolve(op, precond, residTol, krylov_restart_,
+                                                            maxit, verbosity_level);
+                linsolve.apply(soln_, b, result);
+                break;
+            }
+            default:
+                THROW("Unknown Krylov method " << krylov);
+            }
+        }
 
-            // Solve system of linear equations to recover
-            // face/contact pressure values (soln_).
-            linsolve.apply(soln_, rhs_, result);
-            if (!result.converged) {
-                THROW("Linear solver failed to converge in " << result.iterations << " iterations.\n"
-                      << "Residual reduction achieved is " << result.reduction << '\n');
+
+
+        // ----------------------------------------------------------------
+        void reportLinearSolve(const std::string&           config    ,
+                               const double                 setup_time,
+                               const double                 solve_time,
+                               const InverseOperatorResult& result    ,
+                               const int                    verbosity_level)
+        // ----------------------------------------------------------------
+        {
+            linsolve_config_      = config;
+            linsolve_count_      += 1;
+            linsolve_iterations_ += result.iterations;
+            linsolve_setup_time_ += setup_time;
+            linsolve_solve_time_ += solve_time;
+            if (verbosity_level > 0) {
+                std::cout << "Linear solve [" << config << "]: setup " << setup_time
+                          << " s, solve " << solve_time << " s, "
+                          << result.iterations << " iterations." << std::endl;
             }
+        }
 
+
+
+        // ----------------------------------------------------------------
+        std::string amgName() const
+        // ----------------------------------------------------------------
+        {
+            std::string name("AMG(");
+            name += (amg_coupling_ == FirstDiagonalCoupling) ? "first_diagonal," : "row_sum,";
+            name += amg_symmetric_ ? "symmetric," : "unsymmetric,";
+            name += (amg_smoother_ == ILU0Smoother) ? "ilu0" : "ssor";
+            name += amg_anisotropic_ ? ",anisotropic_3d)" : ")";
+            return name;
+        }
+
+
+
+        // ----------------------------------------------------------------
+        static std::string krylovName(const KrylovType krylov)
+        // ----------------------------------------------------------------
+        {
+            switch (krylov) {
+            case CGKrylov:       return "cg";
+            case BiCGStabKrylov: return "bicgstab";
+            case GMResKrylov:    return "gmres";
+            default:             return "default";
+            }
         }
 
 
@@ -1507,7 +2484,7 @@ namespace Dune {
 
 
         // ----------------------------------------------------------------
-        void setExternalContrib(const typename GridInterface::CellIterator c,
+        bool setExternalContrib(const typename GridInterface::CellIterator c,
                                 const int c0, const BCInterface& bc,
                                 const double           src,
                                 std::vector<Scalar>&   rhs,
@@ -1516,6 +2493,7 @@ namespace Dune {
                                 std::vector<int>&      ppartner)
         // ----------------------------------------------------------------
         {
+            // Returns true if the cell has a prescribed pressure.
             typedef typename GridInterface::CellIterator::FaceIterator FI;
 
             const SparseTable<int>& cf = flowSolution_.cellFaces_;
@@ -1527,6 +2505,7 @@ namespace Dune {
 
             g_[c0] = src;
 
+            bool dirichlet = false;
             int k = 0;
             for (FI f = c->facebegin(); f != c->faceend(); ++f, ++k) {
                 if (f->boundary()) {
@@ -1534,7 +2513,7 @@ namespace Dune {
                     if (bcond.isDirichlet()) {
                         facetype[k]        = Dirichlet;
                         condval[k]         = bcond.pressure();
-                        do_regularization_ = false;
+                        dirichlet          = true;
                     } else if (bcond.isPeriodic()) {
                         BdryIdMapIterator j =
                             bdry_id_map_.find(bc.getPeriodicPartner(f->boundaryId()));
@@ -1550,6 +2529,7 @@ namespace Dune {
                     }
                 }
             }
+            return dirichlet;
         }
 
 
@@ -1594,9 +2574,12 @@ namespace Dune {
                             const std::vector<FaceType>& facetype,
                             const std::vector<Scalar>&   condval ,
                             const std::vector<int>&      ppartner,
-                            const L2G&                   l2g)
+                            const L2G&                   l2g     ,
+                            bool                         assemble_matrix)
         // ----------------------------------------------------------------
         {
+            // The matrix entries depend only on the kinds of the
+            // boundary conditions, their values only enter rhs_.
             typedef typename L2G::const_iterator it;
 
             int r = 0;
@@ -1610,8 +2593,10 @@ namespace Dune {
                     // equation of the form: a*x = a*p where 'p' is
                     // the known pressure value (i.e., condval[r]).
                     //
-                    S_  [ii][ii] = S(r,r);
-                    rhs_[ii]     = S(r,r) * condval[r];
+                    if (assemble_matrix) {
+                        S_[ii][ii] = S(r,r);
+                    }
+                    rhs_[ii] = S(r,r) * condval[r];
                     continue;
                 case Periodic:
                     // Periodic boundary condition.  Contact pressures
@@ -1632,15 +2617,15 @@ namespace Dune {
                     {
                         const double a = S(r,r), b = a * condval[r];
 
-                        // Equation (1)
-                        S_  [         ii][         ii] += a;
-                        S_  [         ii][ppartner[r]] -= a;
-                        rhs_[         ii]              += b;
-
-                        // Equation (2)
-                        S_  [ppartner[r]][         ii] -= a;
-                        S_  [ppartner[r]][ppartner[r]] += a;
-                        rhs_[ppartner[r]]              -= b;
+                        if (assemble_matrix) {
+                            // Equations (1) and (2)
+                            S_[         ii][         ii] += a;
+                            S_[         ii][ppartner[r]] -= a;
+                            S_[ppartner[r]][         ii] -= a;
+                            S_[ppartner[r]][ppartner[r]] += a;
+                        }
+                        rhs_[         ii] += b;
+                        rhs_[ppartner[r]] -= b;
                     }
 
                     ii = std::min(ii, ppartner[r]);
@@ -1666,7 +2651,9 @@ namespace Dune {
                                 jj = ppartner[c];
                             }
                         }
-                        S_[ii][jj] += S(r,c);
+                        if (assemble_matrix) {
+                            S_[ii][jj] += S(r,c);
+                        }
                     }
                     break;
                 }
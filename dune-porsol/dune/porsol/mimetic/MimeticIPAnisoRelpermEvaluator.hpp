@@ -97,6 +97,10 @@ namespace Dune {
         ///    type, and usually, @code Scalar @endcode is an alias
         ///    for @code double @endcode.
         typedef typename CellIter::Scalar Scalar;
+        /// @brief
+        ///    The phase mobilities are tensors, so the inverse inner
+        ///    product is not a scalar multiple of a static matrix.
+        enum { ScalarMobility = 0 };
 
 
         /// @brief Default constructor.
@@ -97,6 +97,12 @@ namespace Dune {
         ///    type, and usually, @code Scalar @endcode is an alias
         ///    for @code double @endcode.
         typedef typename CellIter::Scalar Scalar;
+        /// @brief
+        ///    The total mobility enters the inverse inner product as
+        ///    a scalar factor, see @code getInverseMatrix() @endcode.
+        ///    Flow solvers may then form the cell contributions once,
+        ///    at unit mobility, and scale them during assembly.
+        enum { ScalarMobility = 1 };
 
 
         /// @brief Default constructor.
@@ -297,6 +303,38 @@ namespace Dune {
         void computeDynamicParams(const CellIter&         c,
                                   const FluidInterface&   fl,
                                   const std::vector<Sat>& s)
+        {
+            evaluateMobilities(c, fl, s, totmob_, mob_dens_);
+        }
+
+
+        /// @brief
+        ///    Evaluate the total mobility and the density weighted
+        ///    total mobility in a single cell.  Unlike @code
+        ///    computeDynamicParams() @endcode, this does not change
+        ///    the state of the evaluator, and so may be called
+        ///    concurrently for different cells.
+        ///
+        /// @param [in] c
+        ///    Cell for which to evaluate the mobilities.
+        ///
+        /// @param [in] fl
+        ///    Specific fluid properties.
+        ///
+        /// @param [in] s
+        ///    Vector of current fluid saturations.
+        ///
+        /// @param [out] totmob
+        ///    Total mobility, @f$\sum_i \lambda_i@f$.
+        ///
+        /// @param [out] mob_dens
+        ///    Density weighted mobility, @f$\sum_i \rho_i\lambda_i@f$.
+        template<class FluidInterface, class Sat>
+        void evaluateMobilities(const CellIter&         c,
+                                const FluidInterface&   fl,
+                                const std::vector<Sat>& s,
+                                Scalar&                 totmob,
+                                Scalar&                 mob_dens) const
         {
             const int ci = c->index();
 
@@ -305,9 +343,9 @@ namespace Dune {
             fl.phaseMobilities(ci, s[ci], mob);
             fl.phaseDensities (ci, rho);
 
-            totmob_   = std::accumulate   (mob.begin(), mob.end(), Scalar(0.0));
-            mob_dens_ = std::inner_product(rho.begin(), rho.end(), mob.begin(),
-                                           Scalar(0.0));
+            totmob   = std::accumulate   (mob.begin(), mob.end(), Scalar(0.0));
+            mob_dens = std::inner_product(rho.begin(), rho.end(), mob.begin(),
+                                          Scalar(0.0));
         }
 
 
@@ -539,10 +577,22 @@ namespace Dune {
         template<class Vector>
         void gravityFlux(const CellIter& c,
                          Vector&         gflux) const
+        {
+            gravityFlux(c, mob_dens_, gflux);
+        }
+
+        /// @brief
+        ///    Compute gravity flux for all faces of single cell with
+        ///    a given density weighted mobility, see @code
+        ///    evaluateMobilities() @endcode.
+        template<class Vector>
+        void gravityFlux(const CellIter& c,
+                         const Scalar    mob_dens,
+                         Vector&         gflux) const
         {
             std::transform(gflux_[c->index()].begin(), gflux_[c->index()].end(),
                            gflux.begin(),
-                           boost::bind(std::multiplies<Scalar>(), _1, mob_dens_));
+                           boost::bind(std::multiplies<Scalar>(), _1, mob_dens));
         }
 
     private:
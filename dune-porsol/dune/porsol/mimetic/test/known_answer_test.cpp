@@ -231,7 +231,8 @@ void compare_pressure(const GI& g, const std::vector<double>& p)
 
 
 template<class GI, class RI>
-void test_flowsolver(const GI& g, const RI& r, double tol, int kind)
+void test_flowsolver(const GI& g, const RI& r, double tol, int kind,
+                     bool parallel_assembly)
 {
     typedef typename GI::CellIterator                   CI;
     typedef typename CI::FaceIterator                   FI;
@@ -243,6 +244,7 @@ void test_flowsolver(const GI& g, const RI& r, double tol, int kind)
         Dune::MimeticIPEvaluator> FlowSolver;
 
     FlowSolver solver;
+    solver.setParallelAssembly(parallel_assembly);
 
     // FBC flow_bc;
     // assign_bc(g, flow_bc);
@@ -267,6 +269,7 @@ void test_flowsolver(const GI& g, const RI& r, double tol, int kind)
     solver.solve(r, sat, flow_bc, src, tol, 3, kind);
     rolex.stop();
     std::cout << "========== Time in seconds: " << rolex.secsSinceStart() << " =============" << std::endl;
+    solver.printLinearSolverStats(std::cout);
 
     typedef typename FlowSolver::SolutionType FlowSolution;
     FlowSolution soln = solver.getSolution();
@@ -328,5 +331,6 @@ int main(int argc, char** argv)
 
     test_flowsolver(g, res_prop,
                     param.getDefault("tolerance", 1e-8),
-                    param.getDefault("linear_solver_type", 1));
+                    param.getDefault("linear_solver_type", 1),
+                    param.getDefault("parallel_assembly", false));
 }
@@ -0,0 +1,143 @@
+//===========================================================================
+//
+// File: mimetic_reuse_test.cpp
+//
+// Created: Sat Oct 17 18:12:37 2026
+//
+// $Date$
+//
+// $Revision$
+//
+//===========================================================================
+
+/*
+  Copyright 2012 SINTEF ICT, Applied Mathematics.
+  Copyright 2012 Statoil ASA.
+
+  This file is part of The Open Reservoir Simulator Project (OpenRS).
+
+  OpenRS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OpenRS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OpenRS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Checks that reusing the AMG preconditioner gives the same flow
+// solution as a fresh preconditioner when the system matrix changes
+// between solves, and that reuse is refused with ILU0 smoothing.
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <dune/common/array.hh>
+#include <dune/common/mpihelper.hh>
+#include <dune/common/Units.hpp>
+#include <dune/common/param/ParameterGroup.hpp>
+#include <dune/grid/CpGrid.hpp>
+
+#include <dune/porsol/common/GridInterfaceEuler.hpp>
+#include <dune/porsol/common/ReservoirPropertyCapillary.hpp>
+#include <dune/porsol/common/BoundaryConditions.hpp>
+
+#include <dune/porsol/mimetic/MimeticIPEvaluator.hpp>
+#include <dune/porsol/mimetic/IncompFlowSolverHybrid.hpp>
+
+using namespace Dune;
+
+typedef GridInterfaceEuler<CpGrid>                  GI;
+typedef GI::CellIterator                            CI;
+typedef ReservoirPropertyCapillary<3>               RI;
+typedef BasicBoundaryConditions<true, false>        FBC;
+typedef IncompFlowSolverHybrid<GI, RI, FBC, MimeticIPEvaluator> FlowSolver;
+
+// Largest difference in cell pressure between the solutions of two
+// solvers, relative to the largest pressure.
+double pressureDifference(const GI& g, FlowSolver& s1, FlowSolver& s2)
+{
+    FlowSolver::SolutionType soln1 = s1.getSolution();
+    FlowSolver::SolutionType soln2 = s2.getSolution();
+    double max_diff = 0.0;
+    double max_p = 0.0;
+    for (CI c = g.cellbegin(); c != g.cellend(); ++c) {
+        const double p1 = soln1.pressure(c);
+        const double p2 = soln2.pressure(c);
+        max_diff = std::max(max_diff, std::fabs(p1 - p2));
+        max_p = std::max(max_p, std::fabs(p1));
+    }
+    return max_diff/max_p;
+}
+
+int main(int argc, char** argv)
+{
+    MPIHelper::instance(argc, argv);
+
+    CpGrid grid;
+    array<int, 3> dims = {{ 12, 10, 6 }};
+    array<double, 3> cellsz = {{ 10.0, 10.0, 2.0 }};
+    grid.createCartesian(dims, cellsz);
+    GI g(grid);
+
+    RI r;
+    r.init(g.numberOfCells(), 0.2, 0.1*unit::darcy);
+
+    FBC flow_bc(7);
+    flow_bc.flowCond(1) = FlowBC(FlowBC::Dirichlet, 1.0*unit::barsa);
+    flow_bc.flowCond(2) = FlowBC(FlowBC::Dirichlet, 0.0*unit::barsa);
+
+    CI::Vector gravity(0.0);
+    std::vector<double> src(g.numberOfCells(), 0.0);
+
+    parameter::ParameterGroup reuse_param;
+    reuse_param.insertParameter("linsolver_reuse_precond", "true");
+    FlowSolver reused;
+    reused.init(g, r, gravity, flow_bc);
+    reused.initLinearSolver(reuse_param);
+
+    FlowSolver fresh;
+    fresh.init(g, r, gravity, flow_bc);
+
+    // The saturations, and with them the mobilities and the system
+    // matrix, change between the solves.
+    const double tol = 1e-10;
+    bool ok = true;
+    for (int step = 0; step < 4; ++step) {
+        std::vector<double> sat(g.numberOfCells());
+        for (int c = 0; c < g.numberOfCells(); ++c) {
+            sat[c] = double((c*(step + 3)) % 11)/10.0;
+        }
+        reused.solve(r, sat, flow_bc, src, tol, 0);
+        fresh.solve(r, sat, flow_bc, src, tol, 0);
+        const double diff = pressureDifference(g, reused, fresh);
+        std::cout << "Step " << step << ": relative pressure difference " << diff << '\n';
+        ok = ok && diff < 1e-6;
+    }
+    reused.printLinearSolverStats(std::cout);
+
+    // Reuse with ILU0 smoothing must be refused.
+    parameter::ParameterGroup ilu_param;
+    ilu_param.insertParameter("linsolver_reuse_precond", "true");
+    ilu_param.insertParameter("linsolver_smoother", "ilu0");
+    bool refused = false;
+    try {
+        fresh.initLinearSolver(ilu_param);
+    } catch (const std::exception&) {
+        refused = true;
+    }
+    ok = ok && refused;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
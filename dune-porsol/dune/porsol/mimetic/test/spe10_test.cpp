@@ -139,6 +139,8 @@ int main(int argc, char** argv)
 
     FlowSolver solver;
     solver.init(g, r, gravity, flow_bc);
+    solver.initLinearSolver(param);
+    solver.setParallelAssembly(param.getDefault("parallel_assembly", false));
 
 #if 1
     std::vector<double> src(g.numberOfCells(), 0.0);
@@ -167,6 +169,7 @@ int main(int argc, char** argv)
 #endif
 
     solver.solve(r, sat, flow_bc, src, 5.0e-8, 3);
+    solver.printLinearSolverStats(std::cout);
 #endif
 
 #if 1
@@ -84,6 +84,8 @@ namespace Dune
 	residual_tolerance_ = param.getDefault("residual_tolerance", residual_tolerance_);
 	linsolver_verbosity_ = param.getDefault("linsolver_verbosity", linsolver_verbosity_);
         linsolver_type_ = param.getDefault("linsolver_type", linsolver_type_);
+        flow_solver_.initLinearSolver(param);
+        flow_solver_.setParallelAssembly(param.getDefault("parallel_assembly", false));
 
         // Ensure sufficient grid support for requested boundary
         // condition type.
@@ -218,31 +220,39 @@ namespace Dune
 	FieldVector<double, 3> gravity(0.0);
 	// gravity[2] = -Dune::unit::gravity;
 
-	permtensor_t upscaled_K(3, 3, (double*)0);
+	// The pressure drop directions differ only in their boundary
+	// conditions, so solve all of them in one go.  For periodic
+	// and linear conditions the system matrix is the same in all
+	// directions, and the flow solver then assembles it and sets
+	// up its preconditioner only once.
+	std::vector<BCs> bcs(Dimension);
+	std::vector<const BCs*> bcptrs(Dimension);
 	for (int pdd = 0; pdd < Dimension; ++pdd) {
-	    setupUpscalingConditions(ginterf_, bctype_, pdd, 1.0, 1.0, twodim_hack_, bcond_);
-	    if (pdd == 0) {
-		// Only on first iteration, since we do not change the
-		// structure of the system, the way the flow solver is
-		// implemented.
-		flow_solver_.init(ginterf_, res_prop_, gravity, bcond_);
-	    }
+	    setupUpscalingConditions(ginterf_, bctype_, pdd, 1.0, 1.0, twodim_hack_, bcs[pdd]);
+	    bcptrs[pdd] = &bcs[pdd];
+	}
+	bcond_ = bcs[Dimension - 1];
+	// The structure of the system is the same in all directions.
+	flow_solver_.init(ginterf_, res_prop_, gravity, bcs[0]);
 
-	    // Run pressure solver.
-	    flow_solver_.solve(fluid, sat, bcond_, src, residual_tolerance_, linsolver_verbosity_, linsolver_type_);
-            double max_mod = flow_solver_.postProcessFluxes();
+	// Run pressure solver.
+	flow_solver_.solveMultiple(fluid, sat, bcptrs, src, residual_tolerance_, linsolver_verbosity_, linsolver_type_);
+
+	permtensor_t upscaled_K(3, 3, (double*)0);
+	for (int pdd = 0; pdd < Dimension; ++pdd) {
+            double max_mod = flow_solver_.postProcessFluxes(pdd);
             std::cout << "Max mod = " << max_mod << std::endl;
 
 	    // Compute upscaled K.
 	    double Q[Dimension] =  { 0 };
 	    switch (bctype_) {
 	    case Fixed:
-		Q[pdd] = computeAverageVelocity(flow_solver_.getSolution(), pdd, pdd);
+		Q[pdd] = computeAverageVelocity(flow_solver_.getSolution(pdd), pdd, pdd);
 		break;
 	    case Linear:
 	    case Periodic:
 		for (int i = 0; i < Dimension; ++i) {
-		    Q[i] = computeAverageVelocity(flow_solver_.getSolution(), i, pdd);
+		    Q[i] = computeAverageVelocity(flow_solver_.getSolution(pdd), i, pdd);
 		}
 		break;
 	    default: